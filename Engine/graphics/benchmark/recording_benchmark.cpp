@@ -0,0 +1,104 @@
+#include <fmt/format.h>
+
+#include <beyond/graphics/backend.hpp>
+#include <beyond/graphics/command_list.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+/*
+ * Measures how the host cost of submitting many command lists scales with
+ * the number of recording threads
+ *
+ * Each submission carries one list per job of a job system, and every list
+ * dispatches many times over its own pair of buffers.
+ */
+
+namespace {
+
+constexpr int iterations = 200;
+constexpr std::size_t list_count = 64;
+constexpr std::size_t dispatches_per_list = 64;
+constexpr std::uint32_t buffer_size = 1024 * sizeof(std::int32_t);
+
+auto measure_submit(beyond::graphics::Context& context,
+                    gsl::span<const beyond::graphics::CommandList> lists)
+    -> double
+{
+  using Clock = std::chrono::steady_clock;
+
+  // Warms up the command pools and the descriptor cache
+  context.wait(context.submit(lists));
+
+  std::vector<double> samples;
+  samples.reserve(iterations);
+  beyond::graphics::SubmitToken token;
+  for (int i = 0; i < iterations; ++i) {
+    const auto start = Clock::now();
+    token = context.submit(lists);
+    const auto end = Clock::now();
+    samples.push_back(
+        std::chrono::duration<double, std::micro>(end - start).count());
+  }
+  context.wait(token);
+
+  std::sort(samples.begin(), samples.end());
+  return samples[samples.size() / 2];
+}
+
+} // anonymous namespace
+
+int main()
+{
+  using namespace beyond;
+
+  const auto context = graphics::create_headless_context();
+  if (!context) {
+    std::fputs("Error: Cannot create Graphics context\n", stderr);
+    return 1;
+  }
+
+  const auto pipeline =
+      context->create_compute_pipeline(graphics::ComputePipelineCreateInfo{});
+
+  std::vector<graphics::Buffer> buffers;
+  std::vector<graphics::CommandList> lists(list_count);
+  for (auto& list : lists) {
+    const std::array pair = {
+        context->create_buffer({.size = buffer_size}),
+        context->create_buffer({.size = buffer_size}),
+    };
+    buffers.insert(buffers.end(), pair.begin(), pair.end());
+
+    list.bind_pipeline(pipeline);
+    list.bind_buffers(pair);
+    for (std::size_t i = 0; i < dispatches_per_list; ++i) {
+      list.dispatch(16);
+    }
+  }
+
+  fmt::print("submit x{} with {} lists of {} dispatches\n", iterations,
+             list_count, dispatches_per_list);
+
+  const auto max_threads = std::max(1u, std::thread::hardware_concurrency());
+  double single_thread = 0;
+  for (std::uint32_t threads = 1; threads <= max_threads; threads *= 2) {
+    context->set_recording_thread_count(threads);
+    const auto median = measure_submit(*context, lists);
+    if (threads == 1) {
+      single_thread = median;
+    }
+    fmt::print("  {:2} threads: {:9.2f} us (x{:.2f})\n", threads, median,
+               single_thread / median);
+  }
+
+  for (auto& buffer : buffers) {
+    context->destory_buffer(buffer);
+  }
+
+  return 0;
+}
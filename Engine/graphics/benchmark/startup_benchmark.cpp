@@ -0,0 +1,101 @@
+#include <fmt/format.h>
+
+#include <beyond/graphics/backend.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <vector>
+
+/*
+ * Measures the startup cost of creating a context and its pipelines
+ *
+ * The first run starts without a pipeline cache on the disk, and the later
+ * runs load the cache saved by the previous context.
+ */
+
+namespace {
+
+constexpr int warm_iterations = 10;
+// Variants of the built-in shader that compile in one batch
+constexpr std::uint32_t batch_size = 16;
+
+struct StartupTiming {
+  double context = 0; // In milliseconds
+  double pipeline = 0;
+  double batch = 0;
+};
+
+auto measure_startup() -> StartupTiming
+{
+  using Clock = std::chrono::steady_clock;
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+
+  const auto start = Clock::now();
+  const auto context = beyond::graphics::create_headless_context();
+  if (!context) {
+    std::fputs("Error: Cannot create Graphics context\n", stderr);
+    std::exit(1);
+  }
+  const auto context_created = Clock::now();
+
+  [[maybe_unused]] const auto pipeline = context->create_compute_pipeline(
+      beyond::graphics::ComputePipelineCreateInfo{});
+  const auto pipeline_created = Clock::now();
+
+  // Distinct workgroup sizes make distinct pipelines
+  std::vector<beyond::graphics::ComputePipelineCreateInfo> infos(batch_size);
+  for (std::uint32_t i = 0; i < batch_size; ++i) {
+    infos[i].workgroup_size = {(i + 1) * 4, 1, 1};
+  }
+  [[maybe_unused]] const auto pipelines =
+      context->create_compute_pipelines(infos);
+  const auto batch_created = Clock::now();
+
+  return {Milliseconds(context_created - start).count(),
+          Milliseconds(pipeline_created - context_created).count(),
+          Milliseconds(batch_created - pipeline_created).count()};
+}
+
+auto print_timing(const char* name, const StartupTiming& timing) -> void
+{
+  fmt::print("{}\n", name);
+  fmt::print("  context:  {:.3f} ms\n", timing.context);
+  fmt::print("  pipeline: {:.3f} ms\n", timing.pipeline);
+  fmt::print("  batch of {}: {:.3f} ms\n", batch_size, timing.batch);
+}
+
+} // anonymous namespace
+
+int main()
+{
+  using namespace beyond;
+
+  std::error_code error;
+  std::filesystem::remove(graphics::pipeline_cache_path, error);
+  print_timing("cold pipeline cache", measure_startup());
+
+  std::vector<StartupTiming> samples;
+  for (int i = 0; i < warm_iterations; ++i) {
+    samples.push_back(measure_startup());
+  }
+
+  // The median is less sensitive to the noise of driver initialization
+  const auto median = [&](auto member) {
+    std::vector<double> values;
+    for (const auto& sample : samples) {
+      values.push_back(sample.*member);
+    }
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+  };
+  print_timing("warm pipeline cache (median)",
+               {median(&StartupTiming::context),
+                median(&StartupTiming::pipeline),
+                median(&StartupTiming::batch)});
+
+  return 0;
+}
@@ -0,0 +1,111 @@
+#include <fmt/format.h>
+
+#include <beyond/graphics/backend.hpp>
+#include <beyond/graphics/command_list.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <vector>
+
+/*
+ * Measures the host side cost of `Context::submit`
+ *
+ * The workload is kept tiny so that the per-submit overhead of the backend
+ * (command buffer, synchronization and descriptor management) dominates the
+ * timings.
+ */
+
+namespace {
+
+constexpr int warmup_iterations = 100;
+constexpr int iterations = 2000;
+
+// 16384 elements, which is 256 workgroups of the default workgroup size
+constexpr std::uint32_t buffer_size = (2 << 13) * sizeof(std::int32_t);
+constexpr std::uint32_t group_count = 256;
+
+auto run_benchmark(beyond::graphics::Context& context,
+                   const beyond::graphics::CommandList& command_list,
+                   std::size_t dispatch_count) -> void
+{
+  using Clock = std::chrono::steady_clock;
+
+  beyond::graphics::SubmitToken token;
+  for (int i = 0; i < warmup_iterations; ++i) {
+    token = context.submit(command_list);
+  }
+  context.wait(token);
+
+  std::vector<double> samples;
+  samples.reserve(iterations);
+  for (int i = 0; i < iterations; ++i) {
+    const auto start = Clock::now();
+    token = context.submit(command_list);
+    const auto end = Clock::now();
+    samples.push_back(
+        std::chrono::duration<double, std::micro>(end - start).count());
+  }
+  context.wait(token);
+
+  std::sort(samples.begin(), samples.end());
+  const auto mean =
+      std::accumulate(samples.begin(), samples.end(), 0.0) / iterations;
+
+  fmt::print("submit x{} with {} dispatches\n", iterations, dispatch_count);
+  fmt::print("  mean:         {:.2f} us\n", mean);
+  fmt::print("  median:       {:.2f} us\n", samples[samples.size() / 2]);
+  fmt::print("  p99:          {:.2f} us\n", samples[samples.size() * 99 / 100]);
+  fmt::print("  min:          {:.2f} us\n", samples.front());
+  fmt::print("  per dispatch: {:.2f} us\n",
+             mean / static_cast<double>(dispatch_count));
+
+  const auto descriptor_cache = context.descriptor_cache_statistics();
+  fmt::print("  descriptor cache: {} hits, {} misses\n", descriptor_cache.hits,
+             descriptor_cache.misses);
+}
+
+} // anonymous namespace
+
+int main()
+{
+  using namespace beyond;
+
+  const auto context = graphics::create_headless_context();
+  if (!context) {
+    std::fputs("Error: Cannot create Graphics context\n", stderr);
+    return 1;
+  }
+
+  auto in_handle = context->create_buffer(
+      {.size = buffer_size,
+       .memory_usage = graphics::MemoryUsage::host_to_device});
+  auto out_handle = context->create_buffer(
+      {.size = buffer_size,
+       .memory_usage = graphics::MemoryUsage::device_to_host});
+  const auto pipeline_handle =
+      context->create_compute_pipeline(graphics::ComputePipelineCreateInfo{});
+
+  const std::array bindings = {
+      graphics::BufferBinding{in_handle, graphics::BufferAccess::read},
+      graphics::BufferBinding{out_handle, graphics::BufferAccess::write},
+  };
+  for (const std::size_t batch_size : std::array<std::size_t, 3>{1, 16, 256}) {
+    // Every dispatch writes the same output, thus the backend separates them
+    // by barriers
+    graphics::CommandList command_list;
+    command_list.bind_pipeline(pipeline_handle);
+    command_list.bind_buffers(bindings);
+    for (std::size_t i = 0; i < batch_size; ++i) {
+      command_list.dispatch(group_count);
+    }
+    run_benchmark(*context, command_list, batch_size);
+  }
+
+  context->destory_buffer(in_handle);
+  context->destory_buffer(out_handle);
+
+  return 0;
+}
@@ -39,11 +39,89 @@ public:
     beyond::panic("Unimplemented\n");
   }
 
-  auto submit(gsl::span<SubmitInfo>) -> void override
+  [[nodiscard]] auto
+  create_compute_pipelines(gsl::span<const ComputePipelineCreateInfo>)
+      -> std::vector<ComputePipeline> override
   {
     beyond::panic("Unimplemented\n");
   }
 
+  [[nodiscard]] auto
+  create_compute_pipelines_async(gsl::span<const ComputePipelineCreateInfo>)
+      -> std::vector<ComputePipeline> override
+  {
+    beyond::panic("Unimplemented\n");
+  }
+
+  [[nodiscard]] auto is_pipeline_ready(ComputePipeline) -> bool override
+  {
+    beyond::panic("Unimplemented\n");
+  }
+
+  [[nodiscard]] auto workgroup_size(ComputePipeline)
+      -> std::array<std::uint32_t, 3> override
+  {
+    beyond::panic("Unimplemented\n");
+  }
+
+  auto destroy_compute_pipeline(ComputePipeline) -> void override
+  {
+    beyond::panic("Unimplemented\n");
+  }
+
+  auto upload_buffer(Buffer, std::size_t, gsl::span<const std::byte>)
+      -> SubmitToken override
+  {
+    beyond::panic("Unimplemented\n");
+  }
+
+  auto copy_buffer(Buffer, Buffer, gsl::span<const BufferCopyRegion>)
+      -> SubmitToken override
+  {
+    beyond::panic("Unimplemented\n");
+  }
+
+  auto submit_impl(gsl::span<const CommandList>) -> SubmitToken override
+  {
+    beyond::panic("Unimplemented\n");
+  }
+
+  auto set_recording_thread_count(std::uint32_t) -> void override
+  {
+    beyond::panic("Unimplemented\n");
+  }
+
+  [[nodiscard]] auto is_complete(SubmitToken) -> bool override
+  {
+    beyond::panic("Unimplemented\n");
+  }
+
+  auto wait(SubmitToken) -> void override
+  {
+    beyond::panic("Unimplemented\n");
+  }
+
+  auto wait_any(gsl::span<const SubmitToken>) -> std::size_t override
+  {
+    beyond::panic("Unimplemented\n");
+  }
+
+  auto flush_buffer(Buffer, std::size_t, std::size_t) -> void override
+  {
+    beyond::panic("Unimplemented\n");
+  }
+
+  auto invalidate_buffer(Buffer, std::size_t, std::size_t) -> void override
+  {
+    beyond::panic("Unimplemented\n");
+  }
+
+  [[nodiscard]] auto descriptor_cache_statistics() const noexcept
+      -> CacheStatistics override
+  {
+    return {};
+  }
+
 private:
   [[nodiscard]] auto map_memory_impl(Buffer) noexcept -> MappingInfo override
   {
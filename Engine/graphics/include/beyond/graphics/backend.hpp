@@ -8,7 +8,12 @@
  * @brief Interface of the graphics backend
  */
 
+#include <array>
+#include <chrono>
+#include <cstddef>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include <gsl/span>
 
@@ -83,32 +88,156 @@ enum struct MemoryUsage {
 struct BufferCreateInfo {
   std::uint32_t size = 0;
   MemoryUsage memory_usage = MemoryUsage::device;
+  /**
+   * Keeps host visible memory mapped for the whole lifetime of the buffer, so
+   * that `Context::map_memory` returns a cached pointer without mapping or
+   * unmapping. Ignored if the memory ends up not host visible.
+   */
+  bool persistently_mapped = false;
 };
 
+/// @brief Refers to the range from an offset to the end of a buffer
+inline constexpr std::size_t whole_size = static_cast<std::size_t>(-1);
+
 /// @brief A handle to a GPU buffer
 struct Buffer : Handle<Buffer, std::uint32_t, 20, 12> {
   using Handle::Handle;
 };
 
+/// @brief A 32 bit specialization constant of a pipeline
+struct SpecializationConstant {
+  std::uint32_t id = 0;
+  std::uint32_t value = 0; // The bit pattern of the constant
+};
+
 struct ComputePipelineCreateInfo {
+  /**
+   * The SPIR-V words of a compute shader with a `main` entry point, which
+   * only needs to outlive the creation. Backends derive the layout of the
+   * pipeline from the shader itself, where binding `i` of descriptor set `0`
+   * receives the i-th buffer of `CommandList::bind_buffers`. If empty, the
+   * pipeline runs the built-in shader that copies binding `0` to binding `1`.
+   */
+  gsl::span<const std::uint32_t> code;
+
+  /**
+   * The number of invocations in a local workgroup. It is supplied through the
+   * specialization constants `0`, `1` and `2`, which shaders consume with
+   * `local_size_x_id`, `local_size_y_id` and `local_size_z_id`. Shaders with
+   * a literal local size ignore it.
+   */
+  std::array<std::uint32_t, 3> workgroup_size = {64, 1, 1};
+
+  /// Extra specialization constants, where ids `0` to `2` are reserved for
+  /// `workgroup_size`
+  gsl::span<const SpecializationConstant> specialization_constants;
+
+  /**
+   * The size in bytes of the push constants, which dispatches receive inline
+   * through `CommandList::push_constants`. It must be a multiple of 4, and
+   * must not exceed the limit of the device, which is at least 128 bytes.
+   * Backends that reflect shaders extend it to cover the push constant block
+   * of the shader.
+   */
+  std::uint32_t push_constant_size = 0;
+};
+
+/// @brief A region of a buffer to buffer copy, in bytes
+struct BufferCopyRegion {
+  std::size_t src_offset = 0;
+  std::size_t dst_offset = 0;
+  std::size_t size = 0;
 };
 
+/**
+ * @brief Checks that a copy region is non-empty and inside of both buffers
+ *
+ * Copies within the same buffer must not overlap.
+ */
+[[nodiscard]] constexpr auto
+is_valid_copy_region(const BufferCopyRegion& region, std::size_t src_size,
+                     std::size_t dst_size, bool same_buffer) noexcept -> bool
+{
+  const auto inside = [&](std::size_t offset, std::size_t buffer_size) {
+    return offset <= buffer_size && region.size <= buffer_size - offset;
+  };
+  if (region.size == 0 || !inside(region.src_offset, src_size) ||
+      !inside(region.dst_offset, dst_size)) {
+    return false;
+  }
+
+  return !same_buffer || region.src_offset + region.size <= region.dst_offset ||
+         region.dst_offset + region.size <= region.src_offset;
+}
+
+/**
+ * @brief The file where backends persist compiled pipelines between runs
+ *
+ * The path is relative to the working directory of the process, not to the
+ * executable. Running from another directory starts with a cold cache and
+ * writes a separate file there, and a directory that is not writable only
+ * loses the saving.
+ */
+inline constexpr const char* pipeline_cache_path = "pipeline_cache.bin";
+
 /// @brief A handle to a GPU pipeline
-struct ComputePipeline : beyond::NamedType<std::uint32_t, struct PipelineTag,
-                                           beyond::EquableBase> {
+struct ComputePipeline : Handle<ComputePipeline, std::uint32_t, 20, 12> {
+  using Handle::Handle;
+};
+
+/**
+ * @brief A lightweight token that refers to a submission
+ *
+ * Backends may run submissions on several queues, such as dispatches on a
+ * compute queue and uploads on a transfer queue. Submissions of one queue
+ * complete in the submission order, but tokens of different queues are not
+ * ordered, so a completed token says nothing about the submissions of other
+ * queues. A default constructed token does not refer to any submission and is
+ * always complete.
+ */
+struct SubmitToken : beyond::NamedType<std::uint64_t, struct SubmitTokenTag,
+                                       beyond::EquableBase> {
   using NamedType::NamedType;
 };
 
-/// @brief Structure specifying a commands submit operation
-struct SubmitInfo {
-  // Temporaraily hack around
-  Buffer input{};
-  Buffer output{};
-  std::uint32_t buffer_size{};
-  ComputePipeline pipeline;
+/// @brief How the host waits for the device to finish a submission
+enum struct WaitStrategy {
+  /// Sleeps in the driver until the device signals. Cheapest on CPU time.
+  block,
+  /// Polls the submission status for a while before falling back to `block`
+  spin_then_block,
+  /// Polls the submission status until it completes. Lowest latency, but
+  /// burns a CPU core during the whole wait.
+  poll,
+};
+
+/// @brief Configures how a `Context` waits for the device
+struct WaitPolicy {
+  WaitStrategy strategy = WaitStrategy::block;
+  /// Maximum number of polls before blocking in `spin_then_block` mode
+  std::uint32_t spin_count = 1000;
+};
+
+/// @brief Counters of the host waiting for the device
+struct WaitStatistics {
+  /// Number of waits on submissions that were not yet complete
+  std::uint64_t wait_count = 0;
+  /// Number of times the submission status were polled
+  std::uint64_t poll_count = 0;
+  /// Number of waits that ended up blocking in the driver
+  std::uint64_t block_count = 0;
+  /// Total time spent in waiting
+  std::chrono::nanoseconds wait_time{};
+};
+
+/// @brief Hit and miss counters of a cache inside a backend
+struct CacheStatistics {
+  std::uint64_t hits = 0;
+  std::uint64_t misses = 0;
 };
 
 class Context;
+class CommandList;
 
 /**
  * @brief A mapping is a view of host visible device memory
@@ -241,13 +370,64 @@ public:
 
   /**
    * @brief Creates a compute pipeline
-   * @note There are not way to destory a pipeline manually. All pipelines will
-   * be destoryed when the context get destoryed.
+   *
+   * The pipeline lives until `destroy_compute_pipeline`, or until the context
+   * gets destroyed.
    */
   [[nodiscard]] virtual auto
   create_compute_pipeline(const ComputePipelineCreateInfo& create_info)
       -> ComputePipeline = 0;
 
+  /**
+   * @brief Creates several compute pipelines at once
+   *
+   * Backends may compile the pipelines in parallel. Blocks until all of them
+   * are ready.
+   * @return The handles of the pipelines in the order of `create_infos`
+   */
+  [[nodiscard]] virtual auto create_compute_pipelines(
+      gsl::span<const ComputePipelineCreateInfo> create_infos)
+      -> std::vector<ComputePipeline> = 0;
+
+  /**
+   * @brief Starts creating compute pipelines in the background
+   *
+   * The handles are usable right away: submissions that bind a pipeline wait
+   * for it to be ready. Unlike the other creations, the code and constants
+   * in `create_infos` only need to outlive this call.
+   * @return The handles of the pipelines in the order of `create_infos`
+   */
+  [[nodiscard]] virtual auto create_compute_pipelines_async(
+      gsl::span<const ComputePipelineCreateInfo> create_infos)
+      -> std::vector<ComputePipeline> = 0;
+
+  /// @brief Returns `true` if the creation of `pipeline` finished, which is
+  /// always the case for the pipelines not created asynchronously
+  [[nodiscard]] virtual auto is_pipeline_ready(ComputePipeline pipeline)
+      -> bool = 0;
+
+  /**
+   * @brief Gets the number of invocations in a local workgroup of `pipeline`
+   *
+   * This is the local size that the shader runs with, which differs from the
+   * `workgroup_size` of the create info if the shader has a literal local
+   * size. Dispatches should derive their group counts from it. Waits for
+   * pipelines that still compile, and panics if `pipeline` does not refer to
+   * a living pipeline.
+   */
+  [[nodiscard]] virtual auto workgroup_size(ComputePipeline pipeline)
+      -> std::array<std::uint32_t, 3> = 0;
+
+  /**
+   * @brief Destroys a compute pipeline
+   *
+   * Submissions in flight may keep using the pipeline, and backends release
+   * it after they finish. The handle becomes invalid right away, and a later
+   * pipeline may reuse its slot under a new generation. If `pipeline` does
+   * not refer to a living pipeline, this function does nothing.
+   */
+  virtual auto destroy_compute_pipeline(ComputePipeline pipeline) -> void = 0;
+
   /**
    * @brief Destories the device buffer.
    *
@@ -257,22 +437,158 @@ public:
    */
   virtual auto destory_buffer(Buffer& buffer_handle) -> void = 0;
 
-  /// @brief Submits a sequence of command buffers to execute
-  virtual auto submit(gsl::span<SubmitInfo> infos) -> void = 0;
+  /**
+   * @brief Copies `data` into `buffer` starting at `offset` bytes
+   *
+   * The data goes through a staging area owned by the context, so it works
+   * for buffers of any memory usage, including `MemoryUsage::device` buffers
+   * that cannot be mapped. `data` is consumed before this function returns,
+   * and later submissions are ordered after the upload.
+   * @return A token that completes after the device finishes the upload
+   */
+  virtual auto upload_buffer(Buffer buffer, std::size_t offset,
+                             gsl::span<const std::byte> data)
+      -> SubmitToken = 0;
+
+  /**
+   * @brief Copies regions of `src` into `dst` with the transfer commands of
+   * the device
+   *
+   * All regions are copied in one submission, and later submissions are
+   * ordered after the copy. Every region must satisfy `is_valid_copy_region`.
+   * @return A token that completes after the device finishes the copy
+   */
+  virtual auto copy_buffer(Buffer src, Buffer dst,
+                           gsl::span<const BufferCopyRegion> regions)
+      -> SubmitToken = 0;
+
+  /**
+   * @brief Submits the commands recorded in `command_list` to execute
+   *
+   * All the commands go to the device in one submission, which is ordered
+   * after earlier submissions. This function returns as soon as the commands
+   * are handed to the device, without waiting for them to finish executing.
+   * The list can be modified or destroyed right after this call.
+   * @return A token that completes after the device finishes the submission,
+   * or a complete token if `command_list` is empty
+   */
+  auto submit(const CommandList& command_list) -> SubmitToken
+  {
+    return submit_impl(gsl::span<const CommandList>{&command_list, 1});
+  }
+
+  /**
+   * @brief Submits several command lists in one submission
+   *
+   * Lists execute in order, as if a barrier separates each list from the next
+   * one. Backends may translate the lists in parallel on the threads set by
+   * `set_recording_thread_count`, so a job system can record one list per job
+   * and submit all of them at once.
+   * @overload
+   */
+  auto submit(gsl::span<const CommandList> command_lists) -> SubmitToken
+  {
+    return submit_impl(command_lists);
+  }
+
+  /**
+   * @brief Sets the number of threads that translate command lists in a
+   * submission
+   *
+   * A count of `0` or `1` translates on the thread that submits. Backends
+   * without parallel recording ignore the count.
+   */
+  virtual auto set_recording_thread_count(std::uint32_t count) -> void = 0;
+
+  /// @brief Returns `true` if the device finishes the submission of `token`
+  [[nodiscard]] virtual auto is_complete(SubmitToken token) -> bool = 0;
+
+  /// @brief Blocks until the device finishes the submission of `token`
+  virtual auto wait(SubmitToken token) -> void = 0;
+
+  /**
+   * @brief Blocks until at least one of the submissions in `tokens` finishes
+   * @return The index of a completed token in `tokens`, or `0` if `tokens` is
+   * empty, in which case it returns without waiting
+   */
+  virtual auto wait_any(gsl::span<const SubmitToken> tokens) -> std::size_t = 0;
 
   template <typename T> auto map_memory(Buffer buffer) noexcept -> Mapping<T>
   {
     return Mapping<T>{*this, buffer};
   }
 
+  /**
+   * @brief Gets the statistics of reusing descriptor sets across dispatches
+   *
+   * Backends without descriptor sets report zero hits and misses.
+   */
+  [[nodiscard]] virtual auto descriptor_cache_statistics() const noexcept
+      -> CacheStatistics = 0;
+
+  /**
+   * @brief Makes host writes to a range of mapped memory visible to the device
+   *
+   * Only needed for memory types that are not host coherent, and is a no-op
+   * otherwise. Pass `whole_size` as `size` to flush until the end of the
+   * buffer.
+   */
+  virtual auto flush_buffer(Buffer buffer, std::size_t offset,
+                            std::size_t size) -> void = 0;
+
+  /**
+   * @brief Makes device writes to a range of mapped memory visible to the host
+   *
+   * Only needed for memory types that are not host coherent, and is a no-op
+   * otherwise. Pass `whole_size` as `size` to invalidate until the end of the
+   * buffer.
+   */
+  virtual auto invalidate_buffer(Buffer buffer, std::size_t offset,
+                                 std::size_t size) -> void = 0;
+
+  /// @brief Sets how `wait` and `wait_any` wait for the device
+  auto set_wait_policy(const WaitPolicy& policy) noexcept -> void
+  {
+    wait_policy_ = policy;
+  }
+
+  [[nodiscard]] auto wait_policy() const noexcept -> const WaitPolicy&
+  {
+    return wait_policy_;
+  }
+
+  /// @brief Gets the accumulated counters of waiting for the device
+  [[nodiscard]] auto wait_statistics() const noexcept -> const WaitStatistics&
+  {
+    return wait_statistics_;
+  }
+
+  auto reset_wait_statistics() noexcept -> void
+  {
+    wait_statistics_ = {};
+  }
+
 protected:
   Context() = default;
 
+  /**
+   * @brief Waits for the device according to the current `WaitPolicy`
+   * @param poll A callable returns `true` if the awaited work is complete
+   * @param block A callable that blocks until the awaited work is complete
+   *
+   * Backends should call this function only when the awaited work is not yet
+   * complete, so that the statistics reflect the waits actually happened.
+   */
+  template <typename Poll, typename Block>
+  auto wait_with_policy(Poll poll, Block block) -> void;
+
   template <typename T> friend class Mapping;
 
   struct MappingInfo {
     void* data = nullptr;
     std::size_t size = 0; // In bytes
+    // Persistent mappings do not need to be unmapped
+    bool persistent = false;
   };
 
   /**
@@ -290,12 +606,66 @@ protected:
    * @brief Unmaps the underlying memory  of buffer
    */
   virtual auto unmap_memory_impl(Buffer buffer) noexcept -> void = 0;
+
+  /// @brief Submits `command_lists` as a whole, see `submit`
+  virtual auto submit_impl(gsl::span<const CommandList> command_lists)
+      -> SubmitToken = 0;
+
+private:
+  WaitPolicy wait_policy_;
+  WaitStatistics wait_statistics_;
 };
 
+template <typename Poll, typename Block>
+auto Context::wait_with_policy(Poll poll, Block block) -> void
+{
+  const auto start = std::chrono::steady_clock::now();
+  ++wait_statistics_.wait_count;
+
+  bool done = false;
+  switch (wait_policy_.strategy) {
+  case WaitStrategy::block:
+    break;
+  case WaitStrategy::spin_then_block:
+    for (std::uint32_t i = 0; i < wait_policy_.spin_count && !done; ++i) {
+      ++wait_statistics_.poll_count;
+      done = poll();
+    }
+    break;
+  case WaitStrategy::poll:
+    while (!done) {
+      ++wait_statistics_.poll_count;
+      done = poll();
+    }
+    break;
+  }
+
+  if (!done) {
+    ++wait_statistics_.block_count;
+    block();
+  }
+
+  wait_statistics_.wait_time +=
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start);
+}
+
 /// @brief Create a graphics context
 [[nodiscard]] auto create_context(Window& window) noexcept
     -> std::unique_ptr<Context>;
 
+/**
+ * @brief Create a graphics context without a window
+ *
+ * A headless context picks a device by its compute support alone, which makes
+ * it usable on machines without a display and with software implementations.
+ * Creating a swapchain from a headless context is an error.
+ * @return `nullptr` if no backend supports headless contexts, or if the system
+ * has no device that the backend can run on
+ */
+[[nodiscard]] auto create_headless_context() noexcept
+    -> std::unique_ptr<Context>;
+
 template <typename T>
 Mapping<T>::Mapping(Context& context, Buffer buffer)
     : context_{&context}, buffer_{buffer}
@@ -303,18 +673,23 @@ Mapping<T>::Mapping(Context& context, Buffer buffer)
   const auto info = context.map_memory_impl(buffer);
   data_ = static_cast<pointer>(info.data);
   size_ = info.size / sizeof(value_type);
+
+  // A view of a persistently mapped buffer never calls back to the context
+  if (info.persistent) {
+    context_ = nullptr;
+  }
 }
 
 template <typename T> Mapping<T>::~Mapping() noexcept
 {
-  if (*this) {
+  if (*this && context_ != nullptr) {
     context_->unmap_memory_impl(buffer_);
   }
 }
 
 template <typename T> auto Mapping<T>::release() noexcept -> void
 {
-  if (*this) {
+  if (*this && context_ != nullptr) {
     context_->unmap_memory_impl(buffer_);
   }
   context_ = nullptr;
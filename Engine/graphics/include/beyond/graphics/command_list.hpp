@@ -0,0 +1,200 @@
+#pragma once
+
+#ifndef BEYOND_GRAPHICS_COMMAND_LIST_HPP
+#define BEYOND_GRAPHICS_COMMAND_LIST_HPP
+
+/**
+ * @file command_list.hpp
+ * @brief A backend independent recording of GPU commands
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include <gsl/span>
+
+#include "backend.hpp"
+
+namespace beyond::graphics {
+
+/**
+ * @addtogroup graphics
+ * @{
+ * @addtogroup backend
+ * @{
+ */
+
+/// @brief A range of elements in one of the arrays of a `CommandList`
+struct CommandRange {
+  std::uint32_t first = 0;
+  std::uint32_t count = 0;
+};
+
+/// @brief How a dispatch accesses a bound buffer
+enum struct BufferAccess : std::uint8_t {
+  read,
+  write,
+  read_write,
+};
+
+/// @brief A buffer bound to a storage buffer binding
+struct BufferBinding {
+  Buffer buffer;
+  BufferAccess access = BufferAccess::read_write;
+};
+
+/// @brief Binds a compute pipeline for the following dispatches
+struct BindPipelineCommand {
+  ComputePipeline pipeline;
+};
+
+/// @brief Binds buffers to the storage buffer bindings of the pipeline, where
+/// the i-th buffer goes to binding i
+struct BindBuffersCommand {
+  CommandRange bindings;
+};
+
+/// @brief Updates push constants of the bound pipeline, which become undefined
+/// after binding another pipeline
+struct PushConstantsCommand {
+  std::uint32_t offset = 0; // In bytes
+  CommandRange data;
+};
+
+/// @brief Dispatches workgroups with the bound pipeline and buffers
+struct DispatchCommand {
+  std::array<std::uint32_t, 3> group_count = {1, 1, 1};
+};
+
+/// @brief Copies regions between buffers
+struct CopyBufferCommand {
+  Buffer src;
+  Buffer dst;
+  CommandRange regions;
+};
+
+/// @brief Waits for all earlier commands and makes their writes visible to
+/// later commands
+struct BarrierCommand {
+};
+
+using Command =
+    std::variant<BindPipelineCommand, BindBuffersCommand, PushConstantsCommand,
+                 DispatchCommand, CopyBufferCommand, BarrierCommand>;
+
+/**
+ * @brief Records a sequence of commands that `Context::submit` executes as a
+ * unit
+ *
+ * Recording does not touch the device, so lists can be recorded without a
+ * context and reused for many submissions. Backends track how every command
+ * accesses buffers, and make the writes of a command visible to later
+ * commands that access the same buffers, so commands without hazards between
+ * them may overlap on the device. A list that gets re-recorded should be
+ * `clear`ed, which keeps its storage.
+ */
+class CommandList {
+public:
+  auto bind_pipeline(ComputePipeline pipeline) -> void;
+
+  /// @brief Binds buffers that dispatches both read and write
+  auto bind_buffers(gsl::span<const Buffer> buffers) -> void;
+
+  /// @brief Binds buffers with their access, so that reads of the same buffer
+  /// do not get serialized
+  /// @overload
+  auto bind_buffers(gsl::span<const BufferBinding> bindings) -> void;
+
+  /**
+   * @brief Copies `data` into the push constants at `offset` bytes
+   *
+   * Panics if no pipeline is bound, or if `offset` or the size of `data` is
+   * not a multiple of 4. The range must be within the `push_constant_size` of
+   * the bound pipeline.
+   */
+  auto push_constants(std::uint32_t offset, gsl::span<const std::byte> data)
+      -> void;
+
+  /// @brief Copies the bytes of `value` into the push constants at `offset`
+  /// bytes
+  /// @overload
+  template <typename T>
+  requires std::is_trivially_copyable_v<T> &&
+      (!std::is_convertible_v<const T&, gsl::span<const std::byte>>)
+  auto push_constants(std::uint32_t offset, const T& value) -> void
+  {
+    push_constants(offset, gsl::span<const std::byte>{
+                               reinterpret_cast<const std::byte*>(&value),
+                               static_cast<std::ptrdiff_t>(sizeof(T))});
+  }
+
+  /// @brief Dispatches workgroups, panics if no pipeline is bound
+  auto dispatch(std::uint32_t x, std::uint32_t y = 1, std::uint32_t z = 1)
+      -> void;
+
+  /// @brief Copies regions of `src` to `dst`, where every region must satisfy
+  /// `is_valid_copy_region`
+  auto copy_buffer(Buffer src, Buffer dst,
+                   gsl::span<const BufferCopyRegion> regions) -> void;
+
+  /// @brief Records a full barrier, which is only needed for dependencies
+  /// that buffer accesses do not express
+  auto barrier() -> void;
+
+  /// @brief Removes all the recorded commands
+  auto clear() noexcept -> void;
+
+  [[nodiscard]] auto empty() const noexcept -> bool
+  {
+    return commands_.empty();
+  }
+
+  [[nodiscard]] auto commands() const noexcept -> gsl::span<const Command>
+  {
+    return commands_;
+  }
+
+  [[nodiscard]] auto bindings(const BindBuffersCommand& command) const noexcept
+      -> gsl::span<const BufferBinding>
+  {
+    return slice(bindings_, command.bindings);
+  }
+
+  [[nodiscard]] auto data(const PushConstantsCommand& command) const noexcept
+      -> gsl::span<const std::byte>
+  {
+    return slice(data_, command.data);
+  }
+
+  [[nodiscard]] auto regions(const CopyBufferCommand& command) const noexcept
+      -> gsl::span<const BufferCopyRegion>
+  {
+    return slice(regions_, command.regions);
+  }
+
+private:
+  std::vector<Command> commands_;
+  std::vector<BufferBinding> bindings_;
+  std::vector<std::byte> data_;
+  std::vector<BufferCopyRegion> regions_;
+  bool has_pipeline_ = false;
+
+  template <typename T>
+  [[nodiscard]] static auto slice(const std::vector<T>& vector,
+                                  CommandRange range) noexcept
+      -> gsl::span<const T>
+  {
+    return gsl::span<const T>{vector.data() + range.first,
+                              static_cast<std::ptrdiff_t>(range.count)};
+  }
+};
+
+/** @}@} */
+
+} // namespace beyond::graphics
+
+#endif // BEYOND_GRAPHICS_COMMAND_LIST_HPP
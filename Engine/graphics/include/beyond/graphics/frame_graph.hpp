@@ -0,0 +1,218 @@
+#pragma once
+
+#ifndef BEYOND_GRAPHICS_FRAME_GRAPH_HPP
+#define BEYOND_GRAPHICS_FRAME_GRAPH_HPP
+
+/**
+ * @file frame_graph.hpp
+ * @brief Schedules passes of GPU work from the buffers they access
+ */
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "backend.hpp"
+#include "command_list.hpp"
+
+namespace beyond::graphics {
+
+/**
+ * @addtogroup graphics
+ * @{
+ */
+
+/// @brief A handle to a buffer of a frame graph, which is only valid until
+/// the next `FrameGraph::execute`
+struct FrameGraphBuffer
+    : beyond::NamedType<std::uint32_t, struct FrameGraphBufferTag,
+                        beyond::EquableBase> {
+  using NamedType::NamedType;
+};
+
+class FrameGraph;
+
+/// @brief Gives a pass access to the buffers that it declares
+class PassResources {
+public:
+  /// @brief Gets the buffer behind `buffer`, panics if the pass does not
+  /// declare it
+  [[nodiscard]] auto buffer(FrameGraphBuffer buffer) const -> Buffer;
+
+  /// @brief Gets the buffer behind `buffer` together with the access that the
+  /// pass declares for it
+  [[nodiscard]] auto binding(FrameGraphBuffer buffer) const -> BufferBinding;
+
+private:
+  friend class FrameGraph;
+
+  PassResources(const FrameGraph& graph, std::uint32_t pass) noexcept
+      : graph_{&graph}, pass_{pass}
+  {
+  }
+
+  const FrameGraph* graph_;
+  std::uint32_t pass_;
+};
+
+using PassCallback =
+    std::function<void(const PassResources& resources, CommandList& list)>;
+
+/// @brief Declares the buffers that a pass accesses
+class PassBuilder {
+public:
+  auto read(FrameGraphBuffer buffer) -> PassBuilder&
+  {
+    return access(buffer, BufferAccess::read);
+  }
+
+  auto write(FrameGraphBuffer buffer) -> PassBuilder&
+  {
+    return access(buffer, BufferAccess::write);
+  }
+
+  auto read_write(FrameGraphBuffer buffer) -> PassBuilder&
+  {
+    return access(buffer, BufferAccess::read_write);
+  }
+
+  auto access(FrameGraphBuffer buffer, BufferAccess access) -> PassBuilder&;
+
+  /// @brief Keeps the pass even if nothing uses its results, e.g. if it is
+  /// observed through other means than imported buffers
+  auto keep() -> PassBuilder&;
+
+private:
+  friend class FrameGraph;
+
+  PassBuilder(FrameGraph& graph, std::uint32_t pass) noexcept
+      : graph_{&graph}, pass_{pass}
+  {
+  }
+
+  FrameGraph* graph_;
+  std::uint32_t pass_;
+};
+
+/**
+ * @brief Builds the GPU work of a frame from passes, which declare the
+ * buffers they read and write
+ *
+ * On `execute`, the graph:
+ * - culls the passes that do not contribute to any imported buffer or kept
+ *   pass,
+ * - runs the remaining passes in their declaration order, where a pass reads
+ *   the version of a buffer written by the latest pass declared before it,
+ * - records all of them into one command list and submits it at once, and
+ * - places transient buffers with disjoint lifetimes in the same device
+ *   buffer.
+ *
+ * Transient buffers live only during one `execute`, start with undefined
+ * contents, and may be backed by buffers larger than requested. The device
+ * buffers behind them are kept across executions for reuse, and the ones
+ * that an execution does not need get destroyed.
+ *
+ * A graph is meant to be rebuilt every frame: `execute` removes all passes
+ * and buffers after submitting them.
+ */
+class FrameGraph {
+public:
+  explicit FrameGraph(Context& context) noexcept : context_{&context} {}
+  ~FrameGraph();
+
+  FrameGraph(const FrameGraph&) = delete;
+  auto operator=(const FrameGraph&) -> FrameGraph& = delete;
+  FrameGraph(FrameGraph&&) = delete;
+  auto operator=(FrameGraph&&) -> FrameGraph& = delete;
+
+  /// @brief Declares a transient buffer that the graph allocates
+  [[nodiscard]] auto create_buffer(const BufferCreateInfo& create_info)
+      -> FrameGraphBuffer;
+
+  /// @brief Makes a buffer owned elsewhere accessible to passes
+  ///
+  /// Passes that write imported buffers are never culled.
+  [[nodiscard]] auto import_buffer(Buffer buffer) -> FrameGraphBuffer;
+
+  /// @brief Adds a pass that records its commands in `callback`
+  ///
+  /// `callback` only runs during `execute`, and only if the pass is not
+  /// culled.
+  auto add_pass(std::string name, PassCallback callback) -> PassBuilder;
+
+  /**
+   * @brief Compiles the graph, records and submits the passes, then clears
+   * the graph
+   * @return The token of the submission, or a complete token if all passes
+   * are culled
+   */
+  auto execute() -> SubmitToken;
+
+  /// @brief Gets the names of the passes in the order of the last `execute`,
+  /// without the culled ones
+  [[nodiscard]] auto executed_passes() const noexcept
+      -> const std::vector<std::string>&
+  {
+    return executed_passes_;
+  }
+
+  /// @brief Gets the number of device buffers that back transient buffers
+  [[nodiscard]] auto physical_buffer_count() const noexcept -> std::size_t
+  {
+    return physical_buffers_.size();
+  }
+
+private:
+  friend class PassBuilder;
+  friend class PassResources;
+
+  static constexpr std::uint32_t no_index = static_cast<std::uint32_t>(-1);
+
+  struct BufferNode {
+    BufferCreateInfo create_info;
+    Buffer buffer{}; // Imported, or assigned during `execute`
+    bool imported = false;
+  };
+
+  struct BufferUse {
+    FrameGraphBuffer buffer;
+    BufferAccess access = BufferAccess::read_write;
+  };
+
+  struct PassNode {
+    std::string name;
+    PassCallback callback;
+    std::vector<BufferUse> uses;
+    bool kept = false;
+  };
+
+  struct PhysicalBuffer {
+    Buffer buffer;
+    BufferCreateInfo create_info;
+    // The first position in the pass order where this buffer is free
+    std::uint32_t free_from = 0;
+    bool used = false;
+  };
+
+  Context* context_;
+  std::vector<BufferNode> buffers_;
+  std::vector<PassNode> passes_;
+  std::vector<PhysicalBuffer> physical_buffers_;
+  std::vector<std::string> executed_passes_;
+  CommandList command_list_;
+
+  [[nodiscard]] auto buffer_node(FrameGraphBuffer buffer) const
+      -> const BufferNode&;
+  [[nodiscard]] auto cull() const -> std::vector<bool>;
+  [[nodiscard]] auto live_passes(const std::vector<bool>& alive) const
+      -> std::vector<std::uint32_t>;
+  auto assign_physical_buffers(const std::vector<std::uint32_t>& order)
+      -> void;
+};
+
+/** @} */
+
+} // namespace beyond::graphics
+
+#endif // BEYOND_GRAPHICS_FRAME_GRAPH_HPP
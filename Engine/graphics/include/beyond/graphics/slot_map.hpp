@@ -0,0 +1,185 @@
+#pragma once
+
+#ifndef BEYOND_GRAPHICS_SLOT_MAP_HPP
+#define BEYOND_GRAPHICS_SLOT_MAP_HPP
+
+/**
+ * @file slot_map.hpp
+ * @brief A generational container that owns the resources behind handles
+ */
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace beyond::graphics {
+
+/**
+ * @addtogroup graphics
+ * @{
+ */
+
+/**
+ * @brief Stores values behind generational handles
+ *
+ * Erased slots go to a free list and get reused by later insertions with a
+ * bumped generation, so a handle that outlives its value is rejected in O(1)
+ * instead of refering to an unrelated value that reuses its slot.
+ *
+ * Generations start from `1`, thus a default constructed handle never refers
+ * to a value.
+ *
+ * @tparam Handle A `beyond::Handle` type
+ * @tparam T The type of stored values
+ */
+template <typename Handle, typename T> class SlotMap {
+public:
+  using Index = typename Handle::Index;
+  using Generation = typename Handle::Generation;
+  using value_type = T;
+
+  SlotMap() = default;
+
+  /**
+   * @brief Constructs a value in a free slot
+   * @return The handle to the new value, or a default constructed handle if
+   * the index space of `Handle` is exhausted
+   */
+  template <typename... Args>
+  [[nodiscard]] auto emplace(Args&&... args) -> Handle
+  {
+    Index index{};
+    if (!free_list_.empty()) {
+      index = free_list_.back();
+      free_list_.pop_back();
+    } else {
+      index = static_cast<Index>(slots_.size());
+      if (Handle::is_overflow(index)) {
+        return Handle{};
+      }
+      slots_.emplace_back();
+    }
+
+    auto& slot = slots_[index];
+    slot.value.emplace(std::forward<Args>(args)...);
+    ++size_;
+    return Handle{index, slot.generation};
+  }
+
+  /// @brief Returns `true` if `handle` refers to a living value
+  [[nodiscard]] auto contains(Handle handle) const noexcept -> bool
+  {
+    return try_get(handle) != nullptr;
+  }
+
+  /// @brief Gets the value refered by `handle`, or `nullptr` if `handle` is
+  /// stale or invalid
+  [[nodiscard]] auto try_get(Handle handle) noexcept -> T*
+  {
+    const auto index = handle.index();
+    if (index >= slots_.size()) {
+      return nullptr;
+    }
+
+    auto& slot = slots_[index];
+    if (slot.generation != handle.generation() || !slot.value) {
+      return nullptr;
+    }
+    return &*slot.value;
+  }
+
+  /// @overload
+  [[nodiscard]] auto try_get(Handle handle) const noexcept -> const T*
+  {
+    return const_cast<SlotMap&>(*this).try_get(handle);
+  }
+
+  /**
+   * @brief Removes the value refered by `handle`
+   * @return The removed value, or `std::nullopt` if `handle` is stale or
+   * invalid
+   */
+  auto erase(Handle handle) -> std::optional<T>
+  {
+    auto* value = try_get(handle);
+    if (value == nullptr) {
+      return std::nullopt;
+    }
+
+    const auto index = handle.index();
+    auto& slot = slots_[index];
+    std::optional<T> result{std::move(*value)};
+    slot.value.reset();
+    slot.generation = next_generation(index, slot.generation);
+    free_list_.push_back(index);
+    --size_;
+    return result;
+  }
+
+  /// @brief Calls `func` with the handle and value of every living element
+  template <typename Func> auto for_each(Func func) -> void
+  {
+    for (std::size_t i = 0; i < slots_.size(); ++i) {
+      auto& slot = slots_[i];
+      if (slot.value) {
+        func(Handle{static_cast<Index>(i), slot.generation}, *slot.value);
+      }
+    }
+  }
+
+  /// @brief Gets the number of living values
+  [[nodiscard]] auto size() const noexcept -> std::size_t
+  {
+    return size_;
+  }
+
+  [[nodiscard]] auto empty() const noexcept -> bool
+  {
+    return size_ == 0;
+  }
+
+  /// @brief Destroys all values and invalidates all handles
+  auto clear() noexcept -> void
+  {
+    for (std::size_t i = 0; i < slots_.size(); ++i) {
+      auto& slot = slots_[i];
+      if (slot.value) {
+        slot.value.reset();
+        const auto index = static_cast<Index>(i);
+        slot.generation = next_generation(index, slot.generation);
+        free_list_.push_back(index);
+      }
+    }
+    size_ = 0;
+  }
+
+private:
+  static constexpr Generation first_generation = 1;
+
+  struct Slot {
+    std::optional<T> value;
+    Generation generation = first_generation;
+  };
+
+  std::vector<Slot> slots_;
+  std::vector<Index> free_list_;
+  std::size_t size_ = 0;
+
+  // The handle only stores the lower bits of a generation. Wraps around
+  // before a generation gets truncated.
+  [[nodiscard]] static auto next_generation(Index index,
+                                            Generation generation) noexcept
+      -> Generation
+  {
+    auto next = generation;
+    ++next;
+    return Handle{index, next}.generation() == next ? next : first_generation;
+  }
+};
+
+/** @} */
+
+} // namespace beyond::graphics
+
+#endif // BEYOND_GRAPHICS_SLOT_MAP_HPP
@@ -1,11 +1,13 @@
 #include <fmt/format.h>
 
 #include <beyond/graphics/backend.hpp>
+#include <beyond/graphics/command_list.hpp>
 #include <beyond/utils/panic.hpp>
 
 #include <beyond/platform/platform.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <random>
 
@@ -30,15 +32,17 @@ int main()
   // Create buffers
   auto in_handle = context->create_buffer(
       {.size = buffer_size,
-       .memory_usage = graphics::MemoryUsage::host_to_device});
+       .memory_usage = graphics::MemoryUsage::host_to_device,
+       .persistently_mapped = true});
 
   auto out_handle = context->create_buffer(
       {.size = buffer_size,
-       .memory_usage = graphics::MemoryUsage::device_to_host});
+       .memory_usage = graphics::MemoryUsage::device_to_host,
+       .persistently_mapped = true});
 
   // Create pipeline
-  const auto pipeline_handle =
-      context->create_compute_pipeline(graphics::ComputePipelineCreateInfo{});
+  const graphics::ComputePipelineCreateInfo pipeline_info{};
+  const auto pipeline_handle = context->create_compute_pipeline(pipeline_info);
 
   {
     // Filling input buffer
@@ -47,14 +51,23 @@ int main()
     std::uniform_int_distribution<std::int32_t> dist;
     std::generate_n(in_payload.begin(), payload_size,
                     [&]() { return dist(rd); });
+    context->flush_buffer(in_handle, 0, graphics::whole_size);
 
     // Compute
-    std::vector<graphics::SubmitInfo> infos;
-    infos.push_back({in_handle, out_handle, buffer_size, pipeline_handle});
-    context->submit(infos);
+    // One invocation per element, rounded up to whole workgroups
+    const auto local_size = context->workgroup_size(pipeline_handle)[0];
+    const std::array buffers = {in_handle, out_handle};
+    graphics::CommandList command_list;
+    command_list.bind_pipeline(pipeline_handle);
+    command_list.bind_buffers(buffers);
+    const auto group_count = (payload_size + local_size - 1) / local_size;
+    command_list.dispatch(static_cast<std::uint32_t>(group_count));
+    const auto token = context->submit(command_list);
+    context->wait(token);
 
     // Done
     std::puts("Done compute");
+    context->invalidate_buffer(out_handle, 0, graphics::whole_size);
     auto out_payload = context->map_memory<std::int32_t>(out_handle);
     if (!std::equal(in_payload.begin(), in_payload.end(),
                     out_payload.begin())) {
@@ -34,4 +34,14 @@ Context::~Context() = default;
   BEYOND_UNREACHABLE();
 }
 
+[[nodiscard]] auto create_headless_context() noexcept
+    -> std::unique_ptr<Context>
+{
+#ifdef BEYOND_BUILD_GRAPHICS_BACKEND_VULKAN
+  return graphics::vulkan::create_vulkan_headless_context();
+#else
+  return nullptr;
+#endif
+}
+
 } // namespace beyond::graphics
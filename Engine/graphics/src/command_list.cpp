@@ -0,0 +1,89 @@
+#include <beyond/graphics/command_list.hpp>
+#include <beyond/utils/panic.hpp>
+
+namespace beyond::graphics {
+
+namespace {
+
+template <typename T>
+[[nodiscard]] auto append(std::vector<T>& vector, gsl::span<const T> values)
+    -> CommandRange
+{
+  const CommandRange range{static_cast<std::uint32_t>(vector.size()),
+                           static_cast<std::uint32_t>(values.size())};
+  vector.insert(vector.end(), values.begin(), values.end());
+  return range;
+}
+
+} // anonymous namespace
+
+auto CommandList::bind_pipeline(ComputePipeline pipeline) -> void
+{
+  commands_.emplace_back(BindPipelineCommand{pipeline});
+  has_pipeline_ = true;
+}
+
+auto CommandList::bind_buffers(gsl::span<const Buffer> buffers) -> void
+{
+  const CommandRange range{static_cast<std::uint32_t>(bindings_.size()),
+                           static_cast<std::uint32_t>(buffers.size())};
+  for (const auto buffer : buffers) {
+    bindings_.push_back({buffer, BufferAccess::read_write});
+  }
+  commands_.emplace_back(BindBuffersCommand{range});
+}
+
+auto CommandList::bind_buffers(gsl::span<const BufferBinding> bindings) -> void
+{
+  commands_.emplace_back(BindBuffersCommand{append(bindings_, bindings)});
+}
+
+auto CommandList::push_constants(std::uint32_t offset,
+                                 gsl::span<const std::byte> data) -> void
+{
+  if (!has_pipeline_) {
+    beyond::panic("Command list pushes constants without a bound pipeline");
+  }
+  if (offset % 4 != 0 || data.size() % 4 != 0) {
+    beyond::panic("Command list pushes constants that are not 4 byte aligned");
+  }
+  if (data.empty()) {
+    return;
+  }
+  commands_.emplace_back(PushConstantsCommand{offset, append(data_, data)});
+}
+
+auto CommandList::dispatch(std::uint32_t x, std::uint32_t y, std::uint32_t z)
+    -> void
+{
+  if (!has_pipeline_) {
+    beyond::panic("Command list dispatches without a bound pipeline");
+  }
+  commands_.emplace_back(DispatchCommand{{x, y, z}});
+}
+
+auto CommandList::copy_buffer(Buffer src, Buffer dst,
+                              gsl::span<const BufferCopyRegion> regions) -> void
+{
+  if (regions.empty()) {
+    return;
+  }
+  commands_.emplace_back(
+      CopyBufferCommand{src, dst, append(regions_, regions)});
+}
+
+auto CommandList::barrier() -> void
+{
+  commands_.emplace_back(BarrierCommand{});
+}
+
+auto CommandList::clear() noexcept -> void
+{
+  commands_.clear();
+  bindings_.clear();
+  data_.clear();
+  regions_.clear();
+  has_pipeline_ = false;
+}
+
+} // namespace beyond::graphics
@@ -0,0 +1,272 @@
+#include <beyond/graphics/frame_graph.hpp>
+#include <beyond/utils/panic.hpp>
+
+#include <algorithm>
+
+namespace beyond::graphics {
+
+namespace {
+
+[[nodiscard]] constexpr auto writes(BufferAccess access) noexcept -> bool
+{
+  return access != BufferAccess::read;
+}
+
+[[nodiscard]] constexpr auto reads(BufferAccess access) noexcept -> bool
+{
+  return access != BufferAccess::write;
+}
+
+// Whether buffers created with these infos can back each other
+[[nodiscard]] auto is_compatible(const BufferCreateInfo& physical,
+                                 const BufferCreateInfo& requested) noexcept
+    -> bool
+{
+  return physical.memory_usage == requested.memory_usage &&
+         physical.persistently_mapped == requested.persistently_mapped &&
+         physical.size >= requested.size;
+}
+
+} // anonymous namespace
+
+auto PassResources::buffer(FrameGraphBuffer buffer) const -> Buffer
+{
+  return binding(buffer).buffer;
+}
+
+auto PassResources::binding(FrameGraphBuffer buffer) const -> BufferBinding
+{
+  const auto& uses = graph_->passes_[pass_].uses;
+  const auto use = std::find_if(uses.begin(), uses.end(),
+                                [buffer](const FrameGraph::BufferUse& u) {
+                                  return u.buffer.get() == buffer.get();
+                                });
+  if (use == uses.end()) {
+    beyond::panic("Frame graph pass accesses an undeclared buffer");
+  }
+  return {graph_->buffer_node(buffer).buffer, use->access};
+}
+
+auto PassBuilder::access(FrameGraphBuffer buffer, BufferAccess access)
+    -> PassBuilder&
+{
+  (void)graph_->buffer_node(buffer);
+
+  // Declaring both a read and a write of a buffer reads and writes it
+  auto& uses = graph_->passes_[pass_].uses;
+  const auto use = std::find_if(uses.begin(), uses.end(),
+                                [buffer](const FrameGraph::BufferUse& u) {
+                                  return u.buffer.get() == buffer.get();
+                                });
+  if (use == uses.end()) {
+    uses.push_back({buffer, access});
+  } else if (use->access != access) {
+    use->access = BufferAccess::read_write;
+  }
+  return *this;
+}
+
+auto PassBuilder::keep() -> PassBuilder&
+{
+  graph_->passes_[pass_].kept = true;
+  return *this;
+}
+
+FrameGraph::~FrameGraph()
+{
+  for (auto& physical : physical_buffers_) {
+    context_->destory_buffer(physical.buffer);
+  }
+}
+
+auto FrameGraph::create_buffer(const BufferCreateInfo& create_info)
+    -> FrameGraphBuffer
+{
+  buffers_.push_back(
+      {.create_info = create_info, .buffer = Buffer{}, .imported = false});
+  return FrameGraphBuffer{static_cast<std::uint32_t>(buffers_.size() - 1)};
+}
+
+auto FrameGraph::import_buffer(Buffer buffer) -> FrameGraphBuffer
+{
+  buffers_.push_back({.create_info = {}, .buffer = buffer, .imported = true});
+  return FrameGraphBuffer{static_cast<std::uint32_t>(buffers_.size() - 1)};
+}
+
+auto FrameGraph::add_pass(std::string name, PassCallback callback)
+    -> PassBuilder
+{
+  passes_.push_back({.name = std::move(name),
+                     .callback = std::move(callback),
+                     .uses = {},
+                     .kept = false});
+  return PassBuilder{*this, static_cast<std::uint32_t>(passes_.size() - 1)};
+}
+
+auto FrameGraph::execute() -> SubmitToken
+{
+  const auto order = live_passes(cull());
+  assign_physical_buffers(order);
+
+  executed_passes_.clear();
+  command_list_.clear();
+  for (const auto pass : order) {
+    executed_passes_.push_back(passes_[pass].name);
+    if (passes_[pass].callback) {
+      passes_[pass].callback(PassResources{*this, pass}, command_list_);
+    }
+  }
+  const auto token = context_->submit(command_list_);
+
+  buffers_.clear();
+  passes_.clear();
+  return token;
+}
+
+auto FrameGraph::buffer_node(FrameGraphBuffer buffer) const
+    -> const BufferNode&
+{
+  if (buffer.get() >= buffers_.size()) {
+    beyond::panic("Frame graph accesses an invalid buffer handle");
+  }
+  return buffers_[buffer.get()];
+}
+
+auto FrameGraph::cull() const -> std::vector<bool>
+{
+  // Every read sees the latest write of the buffer declared before it
+  std::vector<std::vector<std::uint32_t>> sources(passes_.size());
+  std::vector<std::uint32_t> last_writers(buffers_.size(), no_index);
+  for (std::uint32_t pass = 0; pass < passes_.size(); ++pass) {
+    for (const auto& use : passes_[pass].uses) {
+      const auto writer = last_writers[use.buffer.get()];
+      if (reads(use.access) && writer != no_index) {
+        sources[pass].push_back(writer);
+      }
+    }
+    for (const auto& use : passes_[pass].uses) {
+      if (writes(use.access)) {
+        last_writers[use.buffer.get()] = pass;
+      }
+    }
+  }
+
+  // Walks from the passes with visible results to the passes they read from
+  std::vector<bool> alive(passes_.size(), false);
+  std::vector<std::uint32_t> stack;
+  const auto mark = [&](std::uint32_t pass) {
+    if (!alive[pass]) {
+      alive[pass] = true;
+      stack.push_back(pass);
+    }
+  };
+
+  for (std::uint32_t pass = 0; pass < passes_.size(); ++pass) {
+    const auto& uses = passes_[pass].uses;
+    if (passes_[pass].kept ||
+        std::any_of(uses.begin(), uses.end(), [this](const BufferUse& use) {
+          return writes(use.access) && buffers_[use.buffer.get()].imported;
+        })) {
+      mark(pass);
+    }
+  }
+
+  while (!stack.empty()) {
+    const auto pass = stack.back();
+    stack.pop_back();
+    for (const auto source : sources[pass]) {
+      mark(source);
+    }
+  }
+  return alive;
+}
+
+auto FrameGraph::live_passes(const std::vector<bool>& alive) const
+    -> std::vector<std::uint32_t>
+{
+  // Every dependency points from an earlier declared pass to a later one, so
+  // the declaration order already satisfies all of them
+  std::vector<std::uint32_t> order;
+  order.reserve(static_cast<std::size_t>(
+      std::count(alive.begin(), alive.end(), true)));
+  for (std::uint32_t pass = 0; pass < passes_.size(); ++pass) {
+    if (alive[pass]) {
+      order.push_back(pass);
+    }
+  }
+  return order;
+}
+
+auto FrameGraph::assign_physical_buffers(
+    const std::vector<std::uint32_t>& order) -> void
+{
+  // The lifetime of a transient buffer spans its first and last use in the
+  // pass order
+  struct Lifetime {
+    std::uint32_t buffer = 0;
+    std::uint32_t first = no_index;
+    std::uint32_t last = 0;
+  };
+  std::vector<Lifetime> lifetimes(buffers_.size());
+  for (std::uint32_t position = 0; position < order.size(); ++position) {
+    for (const auto& use : passes_[order[position]].uses) {
+      auto& lifetime = lifetimes[use.buffer.get()];
+      lifetime.buffer = use.buffer.get();
+      lifetime.first = std::min(lifetime.first, position);
+      lifetime.last = position;
+    }
+  }
+  lifetimes.erase(std::remove_if(lifetimes.begin(), lifetimes.end(),
+                                 [this](const Lifetime& lifetime) {
+                                   return lifetime.first == no_index ||
+                                          buffers_[lifetime.buffer].imported;
+                                 }),
+                  lifetimes.end());
+  std::sort(lifetimes.begin(), lifetimes.end(),
+            [](const Lifetime& lhs, const Lifetime& rhs) {
+              return lhs.first < rhs.first;
+            });
+
+  for (auto& physical : physical_buffers_) {
+    physical.free_from = 0;
+    physical.used = false;
+  }
+
+  // Greedily places every buffer in the smallest free physical buffer that
+  // fits it
+  for (const auto& lifetime : lifetimes) {
+    auto& node = buffers_[lifetime.buffer];
+
+    PhysicalBuffer* best = nullptr;
+    for (auto& physical : physical_buffers_) {
+      if (physical.free_from <= lifetime.first &&
+          is_compatible(physical.create_info, node.create_info) &&
+          (best == nullptr ||
+           physical.create_info.size < best->create_info.size)) {
+        best = &physical;
+      }
+    }
+    if (best == nullptr) {
+      best = &physical_buffers_.emplace_back(PhysicalBuffer{
+          .buffer = context_->create_buffer(node.create_info),
+          .create_info = node.create_info});
+    }
+
+    best->free_from = lifetime.last + 1;
+    best->used = true;
+    node.buffer = best->buffer;
+  }
+
+  // Buffers that this execution does not need would only hold memory
+  const auto unused =
+      std::partition(physical_buffers_.begin(), physical_buffers_.end(),
+                     [](const PhysicalBuffer& physical) {
+                       return physical.used;
+                     });
+  for (auto itr = unused; itr != physical_buffers_.end(); ++itr) {
+    context_->destory_buffer(itr->buffer);
+  }
+  physical_buffers_.erase(unused, physical_buffers_.end());
+}
+
+} // namespace beyond::graphics
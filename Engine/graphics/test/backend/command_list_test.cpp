@@ -0,0 +1,168 @@
+#include <catch2/catch.hpp>
+
+#include <beyond/graphics/backend.hpp>
+#include <beyond/graphics/command_list.hpp>
+
+#include "mock_backend.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <numeric>
+#include <variant>
+
+using namespace beyond::graphics;
+
+TEST_CASE("Command list recording", "[beyond.graphics.backend]")
+{
+  CommandList command_list;
+  REQUIRE(command_list.empty());
+
+  const std::array buffers = {Buffer{}, Buffer{}};
+  const std::array bindings = {
+      BufferBinding{.buffer = Buffer{}, .access = BufferAccess::read}};
+  const std::array<std::byte, 4> constants = {std::byte{1}, std::byte{2},
+                                              std::byte{3}, std::byte{4}};
+  command_list.bind_pipeline(ComputePipeline{0});
+  command_list.bind_buffers(buffers);
+  command_list.push_constants(4, constants);
+  command_list.dispatch(16);
+  command_list.barrier();
+  command_list.bind_buffers(bindings);
+  command_list.dispatch(2, 3, 4);
+
+  const auto commands = command_list.commands();
+  REQUIRE(commands.size() == 7);
+
+  SECTION("Commands keep their arguments")
+  {
+    const auto& first_bind = std::get<BindBuffersCommand>(commands[1]);
+    const auto first_bindings = command_list.bindings(first_bind);
+    REQUIRE(first_bindings.size() == 2);
+    REQUIRE(first_bindings[0].access == BufferAccess::read_write);
+
+    const auto& push = std::get<PushConstantsCommand>(commands[2]);
+    REQUIRE(push.offset == 4);
+    const auto data = command_list.data(push);
+    REQUIRE(std::equal(data.begin(), data.end(), constants.begin()));
+
+    const auto& second_bind = std::get<BindBuffersCommand>(commands[5]);
+    const auto second_bindings = command_list.bindings(second_bind);
+    REQUIRE(second_bindings.size() == 1);
+    REQUIRE(second_bindings[0].access == BufferAccess::read);
+
+    const auto& dispatch = std::get<DispatchCommand>(commands[6]);
+    REQUIRE(dispatch.group_count == std::array<std::uint32_t, 3>{2, 3, 4});
+  }
+
+  SECTION("Typed push constants copy the bytes of the value")
+  {
+    struct Parameters {
+      std::uint32_t count;
+      std::uint32_t offset;
+    };
+    const Parameters parameters{.count = 42, .offset = 7};
+    command_list.push_constants(0, parameters);
+
+    const auto all_commands = command_list.commands();
+    const auto& push =
+        std::get<PushConstantsCommand>(all_commands[all_commands.size() - 1]);
+    Parameters pushed{};
+    const auto data = command_list.data(push);
+    REQUIRE(data.size() == sizeof(Parameters));
+    std::memcpy(&pushed, data.data(), sizeof(Parameters));
+    REQUIRE(pushed.count == 42);
+    REQUIRE(pushed.offset == 7);
+  }
+
+  SECTION("Clear removes all the commands")
+  {
+    command_list.clear();
+    REQUIRE(command_list.empty());
+  }
+}
+
+TEST_CASE("Push constants in a command list", "[beyond.graphics.backend]")
+{
+  MockContext context;
+
+  ComputePipelineCreateInfo pipeline_info;
+  pipeline_info.push_constant_size = 8;
+  const auto pipeline = context.create_compute_pipeline(pipeline_info);
+  auto buffer = context.create_buffer({.size = 64});
+  const std::array buffers = {buffer};
+
+  CommandList command_list;
+  command_list.bind_pipeline(pipeline);
+  command_list.bind_buffers(buffers);
+  for (std::uint32_t i = 0; i < 4; ++i) {
+    // Every dispatch gets its own parameters without touching any buffer
+    const std::array<std::uint32_t, 2> parameters = {i * 16, 16};
+    command_list.push_constants(0, parameters);
+    command_list.dispatch(1);
+  }
+  REQUIRE(command_list.commands().size() == 10);
+
+  const auto token = context.submit(command_list);
+  context.wait(token);
+  REQUIRE(context.is_complete(token));
+
+  context.destory_buffer(buffer);
+}
+
+TEST_CASE("Copies in a command list", "[beyond.graphics.backend]")
+{
+  MockContext context;
+
+  constexpr std::size_t count = 8;
+  const BufferCreateInfo info{.size = count * sizeof(int)};
+  const auto first = context.create_buffer(info);
+  const auto second = context.create_buffer(info);
+  const auto third = context.create_buffer(info);
+
+  {
+    auto mapping = context.map_memory<int>(first);
+    std::iota(mapping.begin(), mapping.end(), 1);
+  }
+
+  GIVEN("A chain of copies separated by a barrier")
+  {
+    const std::array whole = {BufferCopyRegion{.size = count * sizeof(int)}};
+    CommandList command_list;
+    command_list.copy_buffer(first, second, whole);
+    command_list.barrier();
+    command_list.copy_buffer(second, third, whole);
+
+    WHEN("Submitted as a unit")
+    {
+      context.wait(context.submit(command_list));
+
+      THEN("The last buffer receives the data of the first one")
+      {
+        const auto mapping = context.map_memory<int>(third);
+        const std::array<int, count> expected = {1, 2, 3, 4, 5, 6, 7, 8};
+        REQUIRE(std::equal(expected.begin(), expected.end(), mapping.data()));
+      }
+    }
+  }
+
+  GIVEN("The same chain split into two lists")
+  {
+    const std::array whole = {BufferCopyRegion{.size = count * sizeof(int)}};
+    std::array<CommandList, 2> command_lists;
+    command_lists[0].copy_buffer(first, second, whole);
+    command_lists[1].copy_buffer(second, third, whole);
+
+    WHEN("Both lists are submitted together")
+    {
+      context.wait(context.submit(command_lists));
+
+      THEN("The lists execute in order")
+      {
+        const auto mapping = context.map_memory<int>(third);
+        const std::array<int, count> expected = {1, 2, 3, 4, 5, 6, 7, 8};
+        REQUIRE(std::equal(expected.begin(), expected.end(), mapping.data()));
+      }
+    }
+  }
+}
@@ -0,0 +1,61 @@
+#include <catch2/catch.hpp>
+
+#include <beyond/graphics/backend.hpp>
+
+#include "mock_backend.hpp"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+
+using namespace beyond::graphics;
+
+TEST_CASE("Copy region validation", "[beyond.graphics.backend]")
+{
+  REQUIRE(is_valid_copy_region({0, 0, 16}, 16, 16, false));
+  REQUIRE(is_valid_copy_region({8, 4, 8}, 16, 12, false));
+  REQUIRE(!is_valid_copy_region({0, 0, 0}, 16, 16, false));
+  REQUIRE(!is_valid_copy_region({12, 0, 8}, 16, 16, false));
+  REQUIRE(!is_valid_copy_region({0, 12, 8}, 16, 16, false));
+
+  SECTION("Regions within the same buffer must not overlap")
+  {
+    REQUIRE(is_valid_copy_region({0, 8, 8}, 16, 16, true));
+    REQUIRE(!is_valid_copy_region({0, 4, 8}, 16, 16, true));
+  }
+}
+
+TEST_CASE("Copy between buffers", "[beyond.graphics.backend]")
+{
+  MockContext context;
+
+  constexpr std::size_t count = 16;
+  const BufferCreateInfo info{.size = count * sizeof(int)};
+  const auto src = context.create_buffer(info);
+  const auto dst = context.create_buffer(info);
+
+  {
+    auto mapping = context.map_memory<int>(src);
+    std::iota(mapping.begin(), mapping.end(), 1);
+  }
+
+  GIVEN("Several regions in a single copy")
+  {
+    const std::array regions = {
+        BufferCopyRegion{
+            .src_offset = 0, .dst_offset = 0, .size = 4 * sizeof(int)},
+        BufferCopyRegion{.src_offset = 8 * sizeof(int),
+                         .dst_offset = 12 * sizeof(int),
+                         .size = 4 * sizeof(int)}};
+    const auto token = context.copy_buffer(src, dst, regions);
+    context.wait(token);
+
+    THEN("Every region is copied and the rest of the destination is untouched")
+    {
+      const auto mapping = context.map_memory<int>(dst);
+      const std::array<int, count> expected = {1, 2, 3, 4, 0, 0,  0,  0,
+                                               0, 0, 0, 0, 9, 10, 11, 12};
+      REQUIRE(std::equal(expected.begin(), expected.end(), mapping.data()));
+    }
+  }
+}
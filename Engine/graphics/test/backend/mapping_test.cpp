@@ -4,6 +4,9 @@
 
 #include "mock_backend.hpp"
 
+#include <algorithm>
+#include <array>
+
 using namespace beyond::graphics;
 
 TEMPLATE_TEST_CASE("default constructed Mapping", "[beyond.graphics.backend]",
@@ -39,5 +42,42 @@ TEST_CASE("Mapping from a backend")
         REQUIRE(*mapping == 1);
       }
     }
+
+    WHEN("Upload data into the buffer at an offset")
+    {
+      const std::array data = {1, 2, 3};
+      const auto token = context.upload_buffer(
+          buffer, sizeof(int), gsl::as_bytes(gsl::span<const int>(data)));
+      context.wait(token);
+
+      THEN("The mapped buffer contains the uploaded data")
+      {
+        const auto mapping = context.map_memory<int>(buffer);
+        REQUIRE(mapping.data()[0] == 0);
+        REQUIRE(std::equal(data.begin(), data.end(), mapping.data() + 1));
+      }
+    }
+
+    WHEN("The buffer is destoryed")
+    {
+      context.destory_buffer(buffer);
+
+      THEN("The stale handle cannot be mapped")
+      {
+        REQUIRE(!context.map_memory<int>(buffer));
+      }
+
+      AND_WHEN("Create a new buffer")
+      {
+        const auto new_buffer = context.create_buffer(info);
+
+        THEN("The stale handle still cannot be mapped")
+        {
+          REQUIRE(new_buffer.index() == buffer.index());
+          REQUIRE(!context.map_memory<int>(buffer));
+          REQUIRE(context.map_memory<int>(new_buffer));
+        }
+      }
+    }
   }
 }
@@ -3,11 +3,18 @@
 #ifndef BEYOND_GRAPHICS_TEST_MOCK_BACKEND_HPP
 #define BEYOND_GRAPHICS_TEST_MOCK_BACKEND_HPP
 
+#include <algorithm>
+#include <array>
 #include <cstdio>
+#include <cstring>
 #include <memory>
 #include <memory_resource>
+#include <vector>
 
 #include <beyond/graphics/backend.hpp>
+#include <beyond/graphics/command_list.hpp>
+#include <beyond/graphics/slot_map.hpp>
+#include <beyond/utils/panic.hpp>
 
 #include <gsl/span>
 
@@ -28,54 +35,280 @@ public:
     return Swapchain{0};
   }
 
-  [[nodiscard]] auto create_buffer(const BufferCreateInfo& info) noexcept
+  [[nodiscard]] auto create_buffer(const BufferCreateInfo& info)
       -> Buffer override
   {
-    const auto index = static_cast<Buffer::Index>(buffers_.size());
-    buffers_.emplace_back(info.size);
-    return Buffer{index};
+    return buffers_.emplace(info.size, &memory_resource_);
   }
 
   auto destory_buffer(Buffer& buffer_handle) -> void override
   {
-    const auto index = static_cast<Buffer::Index>(buffers_.size());
-    if (index >= buffers_.size()) {
+    (void)buffers_.erase(buffer_handle);
+  }
+
+  [[nodiscard]] auto
+  create_compute_pipeline(const ComputePipelineCreateInfo& create_info)
+      -> ComputePipeline override
+  {
+    if (create_info.push_constant_size % 4 != 0 ||
+        create_info.push_constant_size > max_push_constant_size) {
+      beyond::panic("Mock backend creates a pipeline with invalid push "
+                    "constant size");
+    }
+    return pipelines_.emplace(
+        MockPipeline{.push_constant_size = create_info.push_constant_size,
+                     .workgroup_size = create_info.workgroup_size,
+                     .ready = true});
+  }
+
+  [[nodiscard]] auto create_compute_pipelines(
+      gsl::span<const ComputePipelineCreateInfo> create_infos)
+      -> std::vector<ComputePipeline> override
+  {
+    std::vector<ComputePipeline> pipelines;
+    for (const auto& create_info : create_infos) {
+      pipelines.push_back(create_compute_pipeline(create_info));
+    }
+    return pipelines;
+  }
+
+  /// @brief Asynchronous pipelines are pending until `complete_pipelines`, or
+  /// until a submission binds them
+  [[nodiscard]] auto create_compute_pipelines_async(
+      gsl::span<const ComputePipelineCreateInfo> create_infos)
+      -> std::vector<ComputePipeline> override
+  {
+    auto pipelines = create_compute_pipelines(create_infos);
+    for (const auto pipeline : pipelines) {
+      pipelines_.try_get(pipeline)->ready = false;
+    }
+    return pipelines;
+  }
+
+  [[nodiscard]] auto is_pipeline_ready(ComputePipeline pipeline)
+      -> bool override
+  {
+    const auto* mock_pipeline = pipelines_.try_get(pipeline);
+    if (mock_pipeline == nullptr) {
+      beyond::panic("Mock backend queries an invalid pipeline handle");
+    }
+    return mock_pipeline->ready;
+  }
+
+  /// @brief Mock pipelines have no shader, so they run with the workgroup size
+  /// of their create info. Like submissions, waiting for a pending pipeline
+  /// completes it.
+  [[nodiscard]] auto workgroup_size(ComputePipeline pipeline)
+      -> std::array<std::uint32_t, 3> override
+  {
+    auto* mock_pipeline = pipelines_.try_get(pipeline);
+    if (mock_pipeline == nullptr) {
+      beyond::panic("Mock backend queries an invalid pipeline handle");
+    }
+    mock_pipeline->ready = true;
+    return mock_pipeline->workgroup_size;
+  }
+
+  /// @brief Simulates every pending pipeline finishing its compilation
+  auto complete_pipelines() -> void
+  {
+    pipelines_.for_each(
+        [](ComputePipeline, MockPipeline& pipeline) { pipeline.ready = true; });
+  }
+
+  /// @brief The mock device executes submissions on the host, so pipelines
+  /// are released immediately
+  auto destroy_compute_pipeline(ComputePipeline pipeline) -> void override
+  {
+    (void)pipelines_.erase(pipeline);
+  }
+
+  /// @brief Gets the number of living pipelines
+  [[nodiscard]] auto pipeline_count() const noexcept -> std::size_t
+  {
+    return pipelines_.size();
+  }
+
+  /// @brief Copies the data immediately, but still completes the token like a
+  /// submission
+  auto upload_buffer(Buffer buffer, std::size_t offset,
+                     gsl::span<const std::byte> data) -> SubmitToken override
+  {
+    auto* mock_buffer = buffers_.try_get(buffer);
+    const auto size = static_cast<std::size_t>(data.size());
+    if (mock_buffer == nullptr || offset > mock_buffer->size() ||
+        size > mock_buffer->size() - offset) {
+      beyond::panic("Mock backend uploads out of the range of a buffer");
+    }
+
+    if (size != 0) {
+      std::memcpy(mock_buffer->data() + offset, data.data(), size);
+    }
+    return SubmitToken{++submitted_serial_};
+  }
+
+  auto copy_buffer(Buffer src, Buffer dst,
+                   gsl::span<const BufferCopyRegion> regions)
+      -> SubmitToken override
+  {
+    execute_copy(src, dst, regions);
+    return SubmitToken{++submitted_serial_};
+  }
+
+  /// @brief Executes the copies of `command_lists` immediately, while other
+  /// commands only get validated
+  ///
+  /// Submissions are pending until `complete`, `wait` or `wait_any`. The mock
+  /// device finishes a pending submission as soon as the host polls or blocks
+  /// on it.
+  auto submit_impl(gsl::span<const CommandList> command_lists)
+      -> SubmitToken override
+  {
+    if (std::all_of(command_lists.begin(), command_lists.end(),
+                    [](const CommandList& list) { return list.empty(); })) {
+      return SubmitToken{};
+    }
+
+    for (const auto& command_list : command_lists) {
+      std::uint32_t push_constant_size = 0;
+      for (const auto& command : command_list.commands()) {
+        if (const auto* pipeline = std::get_if<BindPipelineCommand>(&command)) {
+          auto* mock_pipeline = pipelines_.try_get(pipeline->pipeline);
+          if (mock_pipeline == nullptr) {
+            beyond::panic("Mock backend binds an invalid pipeline handle");
+          }
+          push_constant_size = mock_pipeline->push_constant_size;
+          // Waits for the compilation
+          mock_pipeline->ready = true;
+        } else if (const auto* push =
+                       std::get_if<PushConstantsCommand>(&command)) {
+          if (push->offset + push->data.count > push_constant_size) {
+            beyond::panic("Mock backend pushes constants out of the range of "
+                          "the pipeline");
+          }
+        } else if (const auto* bind =
+                       std::get_if<BindBuffersCommand>(&command)) {
+          for (const auto& binding : command_list.bindings(*bind)) {
+            if (!buffers_.contains(binding.buffer)) {
+              beyond::panic("Mock backend binds an invalid buffer handle");
+            }
+          }
+        } else if (const auto* copy =
+                       std::get_if<CopyBufferCommand>(&command)) {
+          execute_copy(copy->src, copy->dst, command_list.regions(*copy));
+        }
+      }
+    }
+    return SubmitToken{++submitted_serial_};
+  }
+
+  /// @brief The mock backend always records on the submitting thread
+  auto set_recording_thread_count(std::uint32_t) -> void override {}
+
+  [[nodiscard]] auto is_complete(SubmitToken token) -> bool override
+  {
+    return token.get() <= completed_serial_;
+  }
+
+  auto wait(SubmitToken token) -> void override
+  {
+    if (is_complete(token)) {
       return;
     }
 
-    buffers_[index].clear();
+    const auto finish = [&]() {
+      complete(token);
+      return true;
+    };
+    wait_with_policy(finish, finish);
   }
 
-  [[nodiscard]] auto create_compute_pipeline(const ComputePipelineCreateInfo &
-                                             /*create_info*/)
-      -> ComputePipeline override
+  /// @brief Completes the earliest pending submission if none of `tokens` is
+  /// complete
+  auto wait_any(gsl::span<const SubmitToken> tokens) -> std::size_t override
   {
-    return ComputePipeline{0};
+    const auto completed =
+        std::find_if(tokens.begin(), tokens.end(),
+                     [this](SubmitToken token) { return is_complete(token); });
+    if (completed != tokens.end()) {
+      return static_cast<std::size_t>(completed - tokens.begin());
+    }
+    if (tokens.empty()) {
+      return 0;
+    }
+
+    const auto earliest = std::min_element(
+        tokens.begin(), tokens.end(),
+        [](SubmitToken lhs, SubmitToken rhs) { return lhs.get() < rhs.get(); });
+    wait(*earliest);
+    return static_cast<std::size_t>(earliest - tokens.begin());
   }
 
-  auto submit(gsl::span<SubmitInfo>) -> void override {}
+  /// @brief Simulates the device finishing every submission up to `token`
+  auto complete(SubmitToken token) noexcept -> void
+  {
+    completed_serial_ = std::max(completed_serial_, token.get());
+  }
+
+  /// @brief Mock memory is always coherent
+  auto flush_buffer(Buffer, std::size_t, std::size_t) -> void override {}
+
+  auto invalidate_buffer(Buffer, std::size_t, std::size_t) -> void override {}
+
+  [[nodiscard]] auto descriptor_cache_statistics() const noexcept
+      -> CacheStatistics override
+  {
+    return {};
+  }
 
   [[nodiscard]] auto map_memory_impl(Buffer buffer) noexcept
       -> MappingInfo override
   {
-    const auto index = buffer.index();
-    if (index >= buffers_.size()) {
-      return {nullptr, 0};
-    }
-
-    if (buffers_[index].empty()) {
+    auto* mock_buffer = buffers_.try_get(buffer);
+    if (mock_buffer == nullptr || mock_buffer->empty()) {
       return {nullptr, 0};
     }
 
-    return {buffers_[index].data(), buffers_[index].size()};
+    return {mock_buffer->data(), mock_buffer->size()};
   }
 
   auto unmap_memory_impl(Buffer) noexcept -> void override {}
 
 private:
+  auto execute_copy(Buffer src, Buffer dst,
+                    gsl::span<const BufferCopyRegion> regions) -> void
+  {
+    auto* src_buffer = buffers_.try_get(src);
+    auto* dst_buffer = buffers_.try_get(dst);
+    if (src_buffer == nullptr || dst_buffer == nullptr) {
+      beyond::panic("Mock backend copies an invalid buffer handle");
+    }
+
+    for (const auto& region : regions) {
+      if (!is_valid_copy_region(region, src_buffer->size(), dst_buffer->size(),
+                                src_buffer == dst_buffer)) {
+        beyond::panic("Mock backend copies an invalid buffer region");
+      }
+      std::memcpy(dst_buffer->data() + region.dst_offset,
+                  src_buffer->data() + region.src_offset, region.size);
+    }
+  }
+
   std::pmr::memory_resource& memory_resource_ =
       *std::pmr::get_default_resource();
-  std::pmr::vector<MockBuffer> buffers_;
+  SlotMap<Buffer, MockBuffer> buffers_;
+
+  // The minimum limit that Vulkan guarantees
+  static constexpr std::uint32_t max_push_constant_size = 128;
+  struct MockPipeline {
+    std::uint32_t push_constant_size = 0;
+    std::array<std::uint32_t, 3> workgroup_size{};
+    bool ready = true;
+  };
+  SlotMap<ComputePipeline, MockPipeline> pipelines_;
+
+  std::uint64_t submitted_serial_ = 0;
+  std::uint64_t completed_serial_ = 0;
 };
 
 } // namespace beyond::graphics
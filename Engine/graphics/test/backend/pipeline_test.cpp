@@ -0,0 +1,90 @@
+#include <catch2/catch.hpp>
+
+#include <beyond/graphics/backend.hpp>
+#include <beyond/graphics/command_list.hpp>
+
+#include "mock_backend.hpp"
+
+#include <algorithm>
+#include <array>
+
+using namespace beyond::graphics;
+
+TEST_CASE("Batch pipeline creation", "[beyond.graphics.backend]")
+{
+  MockContext context;
+
+  std::array<ComputePipelineCreateInfo, 3> infos{};
+  infos[1].push_constant_size = 16;
+  infos[1].workgroup_size = {8, 8, 1};
+
+  GIVEN("Pipelines created in a blocking batch")
+  {
+    const auto pipelines = context.create_compute_pipelines(infos);
+
+    THEN("Every create info gets a distinct pipeline that is ready")
+    {
+      REQUIRE(pipelines.size() == infos.size());
+      REQUIRE(pipelines[0] != pipelines[1]);
+      REQUIRE(pipelines[1] != pipelines[2]);
+      REQUIRE(std::all_of(pipelines.begin(), pipelines.end(),
+                          [&](ComputePipeline pipeline) {
+                            return context.is_pipeline_ready(pipeline);
+                          }));
+    }
+  }
+
+  GIVEN("Pipelines created asynchronously")
+  {
+    const auto pipelines = context.create_compute_pipelines_async(infos);
+    REQUIRE(pipelines.size() == infos.size());
+    REQUIRE(!context.is_pipeline_ready(pipelines[0]));
+
+    THEN("A submission that binds a pending pipeline waits for it")
+    {
+      CommandList command_list;
+      command_list.bind_pipeline(pipelines[0]);
+      context.wait(context.submit(command_list));
+      REQUIRE(context.is_pipeline_ready(pipelines[0]));
+      REQUIRE(!context.is_pipeline_ready(pipelines[1]));
+    }
+
+    THEN("Pipelines become ready once their compilation finishes")
+    {
+      context.complete_pipelines();
+      REQUIRE(context.is_pipeline_ready(pipelines[2]));
+    }
+
+    THEN("Querying the workgroup size of a pending pipeline waits for it")
+    {
+      const auto workgroup_size = context.workgroup_size(pipelines[1]);
+      REQUIRE(workgroup_size == infos[1].workgroup_size);
+      REQUIRE(context.is_pipeline_ready(pipelines[1]));
+    }
+  }
+}
+
+TEST_CASE("Pipeline destruction", "[beyond.graphics.backend]")
+{
+  MockContext context;
+
+  const auto pipeline = context.create_compute_pipeline({});
+  context.destroy_compute_pipeline(pipeline);
+  REQUIRE(context.pipeline_count() == 0);
+
+  SECTION("A new pipeline reuses the slot under a new generation")
+  {
+    const auto recreated = context.create_compute_pipeline({});
+    REQUIRE(recreated.index() == pipeline.index());
+    REQUIRE(recreated != pipeline);
+    REQUIRE(context.pipeline_count() == 1);
+  }
+
+  SECTION("Destroying a stale handle does nothing")
+  {
+    const auto recreated = context.create_compute_pipeline({});
+    context.destroy_compute_pipeline(pipeline);
+    REQUIRE(context.is_pipeline_ready(recreated));
+    REQUIRE(context.pipeline_count() == 1);
+  }
+}
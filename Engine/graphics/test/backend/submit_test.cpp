@@ -0,0 +1,124 @@
+#include <catch2/catch.hpp>
+
+#include <beyond/graphics/backend.hpp>
+#include <beyond/graphics/command_list.hpp>
+
+#include "mock_backend.hpp"
+
+#include <array>
+
+using namespace beyond::graphics;
+
+TEST_CASE("Asynchronous submission", "[beyond.graphics.backend]")
+{
+  MockContext context;
+  CommandList command_list;
+  command_list.barrier();
+
+  SECTION("A default constructed token is always complete")
+  {
+    REQUIRE(context.is_complete(SubmitToken{}));
+  }
+
+  SECTION("Waiting for any of no submissions returns immediately")
+  {
+    REQUIRE(context.wait_any(gsl::span<const SubmitToken>{}) == 0);
+  }
+
+  SECTION("Submitting an empty list returns a complete token")
+  {
+    REQUIRE(context.is_complete(context.submit(CommandList{})));
+  }
+
+  GIVEN("Two submissions in flight")
+  {
+    const auto first = context.submit(command_list);
+    const auto second = context.submit(command_list);
+    REQUIRE(first.get() < second.get());
+    REQUIRE(!context.is_complete(first));
+    REQUIRE(!context.is_complete(second));
+
+    WHEN("Wait for the second submission")
+    {
+      context.wait(second);
+
+      THEN("Both submissions are complete")
+      {
+        REQUIRE(context.is_complete(first));
+        REQUIRE(context.is_complete(second));
+      }
+    }
+
+    WHEN("Wait for any of them")
+    {
+      const std::array tokens{second, first};
+      const auto index = context.wait_any(tokens);
+
+      THEN("The earlier submission completes first")
+      {
+        REQUIRE(index == 1);
+        REQUIRE(context.is_complete(first));
+        REQUIRE(!context.is_complete(second));
+      }
+    }
+
+    WHEN("The device finishes the first submission")
+    {
+      context.complete(first);
+
+      THEN("Recording can continue while the second one is in flight")
+      {
+        REQUIRE(context.is_complete(first));
+        REQUIRE(!context.is_complete(second));
+
+        const auto third = context.submit(command_list);
+        const std::array tokens{second, third};
+        REQUIRE(context.wait_any(tokens) == 0);
+      }
+    }
+  }
+}
+
+TEST_CASE("Wait policy", "[beyond.graphics.backend]")
+{
+  MockContext context;
+  CommandList command_list;
+  command_list.barrier();
+
+  SECTION("Blocking by default")
+  {
+    REQUIRE(context.wait_policy().strategy == WaitStrategy::block);
+    context.wait(context.submit(command_list));
+
+    const auto& statistics = context.wait_statistics();
+    REQUIRE(statistics.wait_count == 1);
+    REQUIRE(statistics.poll_count == 0);
+    REQUIRE(statistics.block_count == 1);
+  }
+
+  SECTION("Spin then block")
+  {
+    context.set_wait_policy({.strategy = WaitStrategy::spin_then_block});
+    context.wait(context.submit(command_list));
+
+    const auto& statistics = context.wait_statistics();
+    REQUIRE(statistics.wait_count == 1);
+    REQUIRE(statistics.poll_count == 1);
+    REQUIRE(statistics.block_count == 0);
+  }
+
+  SECTION("Waiting on completed submissions is not counted")
+  {
+    const auto token = context.submit(command_list);
+    context.complete(token);
+    context.wait(token);
+    REQUIRE(context.wait_statistics().wait_count == 0);
+  }
+
+  SECTION("Reset statistics")
+  {
+    context.wait(context.submit(command_list));
+    context.reset_wait_statistics();
+    REQUIRE(context.wait_statistics().wait_count == 0);
+  }
+}
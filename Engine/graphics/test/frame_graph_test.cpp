@@ -0,0 +1,206 @@
+#include <catch2/catch.hpp>
+
+#include <beyond/graphics/frame_graph.hpp>
+
+#include "backend/mock_backend.hpp"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using namespace beyond::graphics;
+
+TEST_CASE("Frame graph scheduling", "[beyond.graphics.frame_graph]")
+{
+  MockContext context;
+  FrameGraph graph{context};
+
+  const BufferCreateInfo info{.size = 64};
+  auto output = context.create_buffer(info);
+
+  const auto imported = graph.import_buffer(output);
+  const auto transient = graph.create_buffer(info);
+  const auto unused = graph.create_buffer(info);
+
+  graph.add_pass("produce", {}).write(transient);
+  graph.add_pass("unused", {}).read(transient).write(unused);
+  graph.add_pass("present", {}).read(transient).write(imported);
+  graph.add_pass("overwrite", {}).write(transient);
+  graph.add_pass("debug", {}).read(transient).keep();
+
+  // None of the passes records commands
+  REQUIRE(context.is_complete(graph.execute()));
+
+  SECTION("Culls passes without visible results and keeps the declared order")
+  {
+    const std::vector<std::string> expected = {"produce", "present",
+                                               "overwrite", "debug"};
+    REQUIRE(graph.executed_passes() == expected);
+  }
+
+  SECTION("Only transient buffers used by the executed passes get allocated")
+  {
+    REQUIRE(graph.physical_buffer_count() == 1);
+  }
+
+  context.destory_buffer(output);
+}
+
+TEST_CASE("Frame graph transient buffers", "[beyond.graphics.frame_graph]")
+{
+  MockContext context;
+  FrameGraph graph{context};
+
+  constexpr std::size_t count = 16;
+  const BufferCreateInfo info{.size = count * sizeof(int)};
+  auto input = context.create_buffer(info);
+  auto output = context.create_buffer(info);
+  {
+    auto mapping = context.map_memory<int>(input);
+    std::iota(mapping.begin(), mapping.end(), 1);
+  }
+
+  std::array<Buffer, 3> physical{};
+  const auto build = [&]() {
+    // A chain of copies through three transient buffers, where the first and
+    // the last one do not live at the same time
+    const auto in = graph.import_buffer(input);
+    const auto out = graph.import_buffer(output);
+    std::array<FrameGraphBuffer, 3> temps = {graph.create_buffer(info),
+                                             graph.create_buffer(info),
+                                             graph.create_buffer(info)};
+
+    const std::array<BufferCopyRegion, 1> region = {
+        BufferCopyRegion{.size = count * sizeof(int)}};
+    const auto add_copy = [&](FrameGraphBuffer src, FrameGraphBuffer dst,
+                              std::size_t temp_index) {
+      graph
+          .add_pass("copy",
+                    [=, &physical](const PassResources& resources,
+                                   CommandList& list) {
+                      if (temp_index < physical.size()) {
+                        physical[temp_index] = resources.buffer(dst);
+                      }
+                      list.copy_buffer(resources.buffer(src),
+                                       resources.buffer(dst), region);
+                    })
+          .read(src)
+          .write(dst);
+    };
+    add_copy(in, temps[0], 0);
+    add_copy(temps[0], temps[1], 1);
+    add_copy(temps[1], temps[2], 2);
+    add_copy(temps[2], out, physical.size());
+  };
+
+  build();
+  context.wait(graph.execute());
+
+  THEN("Buffers with disjoint lifetimes share a device buffer")
+  {
+    REQUIRE(graph.physical_buffer_count() == 2);
+    REQUIRE(physical[0] == physical[2]);
+    REQUIRE(physical[0] != physical[1]);
+  }
+
+  THEN("Data flows through the aliased buffers")
+  {
+    const auto mapping = context.map_memory<int>(output);
+    std::array<int, count> expected{};
+    std::iota(expected.begin(), expected.end(), 1);
+    REQUIRE(std::equal(expected.begin(), expected.end(), mapping.data()));
+  }
+
+  WHEN("The graph gets rebuilt")
+  {
+    const auto previous = physical;
+    build();
+    context.wait(graph.execute());
+
+    THEN("Device buffers are reused across executions")
+    {
+      REQUIRE(graph.physical_buffer_count() == 2);
+      REQUIRE(std::is_permutation(previous.begin(), previous.end(),
+                                  physical.begin()));
+    }
+  }
+
+  context.destory_buffer(input);
+  context.destory_buffer(output);
+}
+
+TEST_CASE("Frame graph buffer versions", "[beyond.graphics.frame_graph]")
+{
+  MockContext context;
+  FrameGraph graph{context};
+
+  constexpr std::size_t count = 16;
+  const BufferCreateInfo info{.size = count * sizeof(int)};
+  std::array<Buffer, 2> inputs = {context.create_buffer(info),
+                                  context.create_buffer(info)};
+  std::array<Buffer, 2> outputs = {context.create_buffer(info),
+                                   context.create_buffer(info)};
+  for (std::size_t i = 0; i < inputs.size(); ++i) {
+    auto mapping = context.map_memory<int>(inputs[i]);
+    std::iota(mapping.begin(), mapping.end(), static_cast<int>(i * 100));
+  }
+
+  const std::array<BufferCopyRegion, 1> region = {
+      BufferCopyRegion{.size = count * sizeof(int)}};
+  const auto add_copy = [&](std::string name, FrameGraphBuffer src,
+                            FrameGraphBuffer dst) {
+    graph
+        .add_pass(std::move(name),
+                  [=](const PassResources& resources, CommandList& list) {
+                    list.copy_buffer(resources.buffer(src),
+                                     resources.buffer(dst), region);
+                  })
+        .read(src)
+        .write(dst);
+  };
+  const auto require_output = [&](std::size_t output, std::size_t input) {
+    const auto actual = context.map_memory<int>(outputs[output]);
+    const auto expected = context.map_memory<int>(inputs[input]);
+    REQUIRE(std::equal(expected.begin(), expected.end(), actual.data()));
+  };
+
+  SECTION("A read sees the latest write declared before it")
+  {
+    const auto temp = graph.create_buffer(info);
+    add_copy("a", graph.import_buffer(inputs[0]), temp);
+    add_copy("b", temp, graph.import_buffer(outputs[0]));
+    add_copy("c", graph.import_buffer(inputs[1]), temp);
+    add_copy("d", temp, graph.import_buffer(outputs[1]));
+    context.wait(graph.execute());
+
+    const std::vector<std::string> expected = {"a", "b", "c", "d"};
+    REQUIRE(graph.executed_passes() == expected);
+    require_output(0, 0);
+    require_output(1, 1);
+  }
+
+  SECTION("Buffers can be written again after being read")
+  {
+    // Ping-pongs between two transient buffers
+    const auto ping = graph.create_buffer(info);
+    const auto pong = graph.create_buffer(info);
+    add_copy("a", graph.import_buffer(inputs[0]), ping);
+    add_copy("b", ping, pong);
+    add_copy("c", pong, ping);
+    add_copy("d", ping, graph.import_buffer(outputs[0]));
+    context.wait(graph.execute());
+
+    const std::vector<std::string> expected = {"a", "b", "c", "d"};
+    REQUIRE(graph.executed_passes() == expected);
+    require_output(0, 0);
+  }
+
+  for (auto& buffer : inputs) {
+    context.destory_buffer(buffer);
+  }
+  for (auto& buffer : outputs) {
+    context.destory_buffer(buffer);
+  }
+}
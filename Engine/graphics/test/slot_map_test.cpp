@@ -0,0 +1,80 @@
+#include <catch2/catch.hpp>
+
+#include <beyond/graphics/backend.hpp>
+#include <beyond/graphics/slot_map.hpp>
+
+#include <string>
+
+using namespace beyond::graphics;
+
+TEST_CASE("SlotMap", "[beyond.graphics.slot_map]")
+{
+  SlotMap<Buffer, std::string> slot_map;
+  REQUIRE(slot_map.empty());
+
+  SECTION("A default constructed handle refers to nothing")
+  {
+    REQUIRE(!slot_map.contains(Buffer{}));
+    REQUIRE(slot_map.try_get(Buffer{}) == nullptr);
+  }
+
+  GIVEN("A value inserted into the slot map")
+  {
+    const auto handle = slot_map.emplace("hello");
+    REQUIRE(slot_map.size() == 1);
+    REQUIRE(slot_map.contains(handle));
+    REQUIRE(*slot_map.try_get(handle) == "hello");
+
+    WHEN("Erase the value")
+    {
+      const auto erased = slot_map.erase(handle);
+
+      THEN("The erased value is returned and the handle becomes stale")
+      {
+        REQUIRE(erased == "hello");
+        REQUIRE(slot_map.empty());
+        REQUIRE(!slot_map.contains(handle));
+        REQUIRE(!slot_map.erase(handle));
+      }
+
+      AND_WHEN("Insert another value")
+      {
+        const auto new_handle = slot_map.emplace("world");
+
+        THEN("The slot is reused with a new generation")
+        {
+          REQUIRE(new_handle.index() == handle.index());
+          REQUIRE(new_handle.generation() != handle.generation());
+          REQUIRE(slot_map.try_get(handle) == nullptr);
+          REQUIRE(*slot_map.try_get(new_handle) == "world");
+        }
+      }
+    }
+
+    WHEN("Clear the slot map")
+    {
+      slot_map.clear();
+
+      THEN("All handles become stale")
+      {
+        REQUIRE(slot_map.empty());
+        REQUIRE(!slot_map.contains(handle));
+      }
+    }
+  }
+
+  SECTION("Visits every living value")
+  {
+    const auto first = slot_map.emplace("first");
+    const auto second = slot_map.emplace("second");
+    (void)slot_map.erase(first);
+
+    std::size_t count = 0;
+    slot_map.for_each([&](Buffer handle, std::string& value) {
+      ++count;
+      REQUIRE(handle.index() == second.index());
+      REQUIRE(value == "second");
+    });
+    REQUIRE(count == 1);
+  }
+}
@@ -0,0 +1,50 @@
+#include <catch2/catch.hpp>
+
+#include <beyond/graphics/backend.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+
+using namespace beyond::graphics;
+
+TEST_CASE("Headless buffer round trip", "[beyond.graphics.vulkan]")
+{
+  const auto context = create_headless_context();
+  if (context == nullptr) {
+    WARN("Skipped since the system has no device for a headless context");
+    return;
+  }
+
+  constexpr std::size_t count = 64;
+  constexpr auto size = static_cast<std::uint32_t>(count * sizeof(int));
+
+  auto src = context->create_buffer({.size = size});
+  auto dst = context->create_buffer({.size = size});
+  auto readback = context->create_buffer(
+      {.size = size, .memory_usage = MemoryUsage::device_to_host});
+
+  std::array<int, count> data{};
+  std::iota(data.begin(), data.end(), 1);
+  (void)context->upload_buffer(src, 0,
+                               gsl::as_bytes(gsl::span<const int>(data)));
+
+  // Later submissions are ordered after the upload and the first copy, so
+  // only the last copy is waited for
+  const std::array regions = {
+      BufferCopyRegion{.src_offset = 0, .dst_offset = 0, .size = size}};
+  (void)context->copy_buffer(src, dst, regions);
+  context->wait(context->copy_buffer(dst, readback, regions));
+
+  context->invalidate_buffer(readback, 0, whole_size);
+  {
+    const auto mapping = context->map_memory<int>(readback);
+    REQUIRE(std::equal(data.begin(), data.end(), mapping.data()));
+  }
+
+  context->destory_buffer(src);
+  context->destory_buffer(dst);
+  context->destory_buffer(readback);
+}
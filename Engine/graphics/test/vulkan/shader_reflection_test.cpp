@@ -0,0 +1,288 @@
+#include <catch2/catch.hpp>
+
+#include "vulkan_shader_reflection.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <initializer_list>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace beyond::graphics::vulkan;
+
+namespace {
+
+// Assembles SPIR-V modules instruction by instruction
+class SpirvBuilder {
+public:
+  static constexpr std::uint32_t bound = 32;
+  static constexpr std::uint32_t main_id = bound - 1;
+
+  SpirvBuilder()
+  {
+    // OpEntryPoint GLCompute %main "main"
+    op(15, {5, main_id, 0x6E69616D, 0});
+  }
+
+  auto op(std::uint32_t opcode, std::initializer_list<std::uint32_t> operands)
+      -> SpirvBuilder&
+  {
+    const auto word_count = static_cast<std::uint32_t>(operands.size() + 1);
+    words_.push_back(word_count << 16u | opcode);
+    words_.insert(words_.end(), operands.begin(), operands.end());
+    return *this;
+  }
+
+  [[nodiscard]] auto words() const -> const std::vector<std::uint32_t>&
+  {
+    return words_;
+  }
+
+private:
+  std::vector<std::uint32_t> words_ = {0x07230203, 0x00010000, 0, bound, 0};
+};
+
+namespace op {
+constexpr std::uint32_t execution_mode = 16;
+constexpr std::uint32_t type_int = 21;
+constexpr std::uint32_t type_float = 22;
+constexpr std::uint32_t type_vector = 23;
+constexpr std::uint32_t type_matrix = 24;
+constexpr std::uint32_t type_runtime_array = 29;
+constexpr std::uint32_t type_struct = 30;
+constexpr std::uint32_t type_pointer = 32;
+constexpr std::uint32_t constant = 43;
+constexpr std::uint32_t spec_constant = 50;
+constexpr std::uint32_t spec_constant_composite = 51;
+constexpr std::uint32_t variable = 59;
+constexpr std::uint32_t decorate = 71;
+constexpr std::uint32_t member_decorate = 72;
+constexpr std::uint32_t execution_mode_id = 331;
+} // namespace op
+
+constexpr std::uint32_t main_id = SpirvBuilder::main_id;
+
+// A shader with storage buffers at set 0, binding 1 and at set 1, binding 0
+// whose variables are decorated, and one at set 0, binding 0 whose block
+// members are decorated, where the ones at binding 1 and binding 0 of set 0
+// are read-only
+auto storage_buffers_shader() -> SpirvBuilder
+{
+  SpirvBuilder builder;
+  builder.op(op::execution_mode, {main_id, 17, 64, 2, 1})
+      .op(op::decorate, {5, 33, 1})
+      .op(op::decorate, {5, 34, 0})
+      .op(op::decorate, {5, 24})
+      .op(op::decorate, {6, 33, 0})
+      .op(op::decorate, {6, 34, 1})
+      .op(op::decorate, {9, 33, 0})
+      .op(op::decorate, {9, 34, 0})
+      .op(op::member_decorate, {7, 0, 24})
+      .op(op::member_decorate, {7, 1, 24})
+      .op(op::type_int, {1, 32, 1})
+      .op(op::type_runtime_array, {2, 1})
+      .op(op::type_struct, {3, 2})
+      .op(op::type_pointer, {4, 12, 3})
+      .op(op::variable, {4, 5, 12})
+      .op(op::variable, {4, 6, 12})
+      .op(op::type_struct, {7, 1, 2})
+      .op(op::type_pointer, {8, 12, 7})
+      .op(op::variable, {8, 9, 12});
+  return builder;
+}
+
+[[nodiscard]] auto reflect(const std::vector<std::uint32_t>& words)
+{
+  return try_reflect_compute_shader(words);
+}
+
+} // anonymous namespace
+
+TEST_CASE("Shader reflection of the copy shader",
+          "[beyond.graphics.vulkan.shader_reflection]")
+{
+  std::ifstream file{std::string{BEYOND_TEST_SHADERS_DIR} + "/copy.comp.spv",
+                     std::ios::binary};
+  REQUIRE(file);
+  const std::vector<char> bytes(std::istreambuf_iterator<char>{file},
+                                std::istreambuf_iterator<char>{});
+  REQUIRE(bytes.size() % sizeof(std::uint32_t) == 0);
+  std::vector<std::uint32_t> words(bytes.size() / sizeof(std::uint32_t));
+  std::copy(bytes.begin(), bytes.end(), reinterpret_cast<char*>(words.data()));
+
+  const auto reflection = reflect_compute_shader(words);
+
+  REQUIRE(reflection.bindings.size() == 2);
+  for (std::uint32_t i = 0; i < 2; ++i) {
+    const auto& binding = reflection.bindings[i];
+    REQUIRE(binding.set == 0);
+    REQUIRE(binding.binding == i);
+    REQUIRE(binding.type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+    REQUIRE(binding.count == 1);
+    REQUIRE(!binding.read_only);
+  }
+  REQUIRE(reflection.push_constant_size == 0);
+  REQUIRE(reflection.local_size == std::array<std::uint32_t, 3>{1, 1, 1});
+  REQUIRE(reflection.local_size_spec_ids ==
+          std::array<std::uint32_t, 3>{0, 1, 2});
+}
+
+TEST_CASE("Shader reflection of descriptors",
+          "[beyond.graphics.vulkan.shader_reflection]")
+{
+  const auto reflection = reflect(storage_buffers_shader().words());
+  REQUIRE(reflection.has_value());
+
+  const auto& bindings = reflection->bindings;
+  REQUIRE(bindings.size() == 3);
+
+  SECTION("Bindings are sorted by set and then by binding")
+  {
+    REQUIRE(bindings[0].set == 0);
+    REQUIRE(bindings[0].binding == 0);
+    REQUIRE(bindings[1].set == 0);
+    REQUIRE(bindings[1].binding == 1);
+    REQUIRE(bindings[2].set == 1);
+    REQUIRE(bindings[2].binding == 0);
+    for (const auto& binding : bindings) {
+      REQUIRE(binding.type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+      REQUIRE(binding.count == 1);
+    }
+  }
+
+  SECTION("NonWritable variables and blocks of NonWritable members are "
+          "read-only")
+  {
+    REQUIRE(bindings[0].read_only);
+    REQUIRE(bindings[1].read_only);
+    REQUIRE(!bindings[2].read_only);
+  }
+
+  SECTION("A fixed local size has no specialization constants")
+  {
+    REQUIRE(reflection->local_size == std::array<std::uint32_t, 3>{64, 2, 1});
+    REQUIRE(reflection->local_size_spec_ids ==
+            std::array<std::uint32_t, 3>{no_spec_id, no_spec_id, no_spec_id});
+  }
+}
+
+TEST_CASE("Shader reflection of push constants",
+          "[beyond.graphics.vulkan.shader_reflection]")
+{
+  // struct { vec4 a; mat4 b; uint c; } with a mat4 at offset 16 of stride 16
+  SpirvBuilder builder;
+  builder.op(op::member_decorate, {5, 0, 35, 0})
+      .op(op::member_decorate, {5, 1, 35, 16})
+      .op(op::member_decorate, {5, 1, 7, 16})
+      .op(op::member_decorate, {5, 2, 35, 80})
+      .op(op::type_float, {1, 32})
+      .op(op::type_vector, {2, 1, 4})
+      .op(op::type_matrix, {3, 2, 4})
+      .op(op::type_int, {4, 32, 0})
+      .op(op::type_struct, {5, 2, 3, 4})
+      .op(op::type_pointer, {6, 9, 5})
+      .op(op::variable, {6, 7, 9});
+
+  const auto reflection = reflect(builder.words());
+  REQUIRE(reflection.has_value());
+  REQUIRE(reflection->push_constant_size == 84);
+  REQUIRE(reflection->bindings.empty());
+}
+
+TEST_CASE("Shader reflection of the local size",
+          "[beyond.graphics.vulkan.shader_reflection]")
+{
+  // %2 is a specialization constant of id 5 that defaults to 32, and %3 is
+  // a constant 4
+  SpirvBuilder builder;
+  builder.op(op::decorate, {2, 1, 5})
+      .op(op::type_int, {1, 32, 0})
+      .op(op::spec_constant, {1, 2, 32})
+      .op(op::constant, {1, 3, 4});
+
+  SECTION("LocalSizeId takes the specialization ids of its constants")
+  {
+    builder.op(op::execution_mode_id, {main_id, 38, 2, 3, 3});
+
+    const auto reflection = reflect(builder.words());
+    REQUIRE(reflection.has_value());
+    REQUIRE(reflection->local_size == std::array<std::uint32_t, 3>{32, 4, 4});
+    REQUIRE(reflection->local_size_spec_ids ==
+            std::array<std::uint32_t, 3>{5, no_spec_id, no_spec_id});
+  }
+
+  SECTION("A WorkgroupSize constant overrides LocalSize")
+  {
+    builder.op(op::execution_mode, {main_id, 17, 1, 1, 1})
+        .op(op::decorate, {5, 11, 25})
+        .op(op::type_vector, {4, 1, 3})
+        .op(op::spec_constant_composite, {4, 5, 3, 2, 3});
+
+    const auto reflection = reflect(builder.words());
+    REQUIRE(reflection.has_value());
+    REQUIRE(reflection->local_size == std::array<std::uint32_t, 3>{4, 32, 4});
+    REQUIRE(reflection->local_size_spec_ids ==
+            std::array<std::uint32_t, 3>{no_spec_id, 5, no_spec_id});
+  }
+}
+
+TEST_CASE("Shader reflection rejects invalid SPIR-V",
+          "[beyond.graphics.vulkan.shader_reflection]")
+{
+  auto words = storage_buffers_shader().words();
+  REQUIRE(reflect(words).has_value());
+
+  SECTION("Code shorter than the header")
+  {
+    REQUIRE(!reflect({}).has_value());
+    words.resize(4);
+    REQUIRE(!reflect(words).has_value());
+  }
+
+  SECTION("Code with a bad magic number")
+  {
+    words[0] = 0x03022307;
+    REQUIRE(!reflect(words).has_value());
+  }
+
+  SECTION("Code truncated in the middle of an instruction")
+  {
+    words.pop_back();
+    REQUIRE(!reflect(words).has_value());
+  }
+
+  SECTION("An instruction of zero words")
+  {
+    words.push_back(0);
+    REQUIRE(!reflect(words).has_value());
+  }
+
+  SECTION("An id beyond the bound of the module")
+  {
+    words[3] = 8;
+    REQUIRE(!reflect(words).has_value());
+  }
+
+  SECTION("A member index beyond any struct")
+  {
+    const auto builder =
+        storage_buffers_shader().op(op::member_decorate, {7, 0xFFFFFFFF, 24});
+    REQUIRE(!reflect(builder.words()).has_value());
+  }
+
+  SECTION("A variable of an undefined type")
+  {
+    const auto builder = storage_buffers_shader().op(op::variable, {20, 21, 12});
+    REQUIRE(!reflect(builder.words()).has_value());
+  }
+
+  SECTION("Code without a main compute entry point")
+  {
+    // Turns the execution model of the entry point into GLCompute + 1
+    words[6] = 6;
+    REQUIRE(!reflect(words).has_value());
+  }
+}
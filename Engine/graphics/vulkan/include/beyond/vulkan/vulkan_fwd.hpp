@@ -9,9 +9,17 @@
 namespace beyond::graphics::vulkan {
 
 /// @brief Create a VulkanGraphicsContext
+/// @note Panics if the system does not provide Vulkan 1.2 with timeline
+/// semaphores
 [[nodiscard]] auto create_vulkan_context(Window& window) noexcept
     -> std::unique_ptr<Context>;
 
+/// @brief Create a VulkanGraphicsContext without a window or surface
+/// @return `nullptr` if the system does not provide Vulkan 1.2 with timeline
+/// semaphores
+[[nodiscard]] auto create_vulkan_headless_context() noexcept
+    -> std::unique_ptr<Context>;
+
 } // namespace beyond::graphics::vulkan
 
 #endif // BEYOND_GRAPHICS_VULKAN_FWD_HPP
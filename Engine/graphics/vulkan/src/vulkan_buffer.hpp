@@ -6,12 +6,24 @@
 #include <vk_mem_alloc.h>
 #include <volk.h>
 
+#include "vulkan_queue.hpp"
+
 #include <utility>
 
 #include <beyond/utils/panic.hpp>
 
 namespace beyond::graphics::vulkan {
 
+/// @brief The latest accesses of a buffer by the commands of a queue
+struct BufferAccesses {
+  // The latest write
+  VkPipelineStageFlags write_stages = 0;
+  VkAccessFlags write_access = 0;
+  // Reads since the latest write, which have their write made visible
+  VkPipelineStageFlags read_stages = 0;
+  VkAccessFlags read_access = 0;
+};
+
 /// @brief Half RAII wrapper of a vulkan buffer
 ///
 /// The buffer is allocated in the outside code but destoryed in the destructor.
@@ -21,9 +33,10 @@ public:
   VulkanBuffer() = default;
 
   VulkanBuffer(VmaAllocator allocator, VkBuffer buffer,
-               VmaAllocation allocation, std::uint32_t size)
-      : allocator_{allocator}, buffer_{buffer},
-        allocation_{allocation}, size_{size}
+               VmaAllocation allocation, std::uint32_t size,
+               void* persistent_data = nullptr)
+      : allocator_{allocator}, buffer_{buffer}, allocation_{allocation},
+        size_{size}, persistent_data_{persistent_data}
   {
   }
 
@@ -41,7 +54,10 @@ public:
       : allocator_{std::exchange(other.allocator_, nullptr)},
         buffer_{std::exchange(other.buffer_, nullptr)},
         allocation_{std::exchange(other.allocation_, nullptr)},
-        size_{std::exchange(other.size_, 0)}
+        size_{std::exchange(other.size_, 0)},
+        persistent_data_{std::exchange(other.persistent_data_, nullptr)},
+        last_accesses_{std::exchange(other.last_accesses_, {})},
+        last_uses_{std::exchange(other.last_uses_, {})}
   {
   }
 
@@ -51,14 +67,17 @@ public:
     buffer_ = std::exchange(other.buffer_, nullptr);
     allocation_ = std::exchange(other.allocation_, nullptr);
     size_ = std::exchange(other.size_, 0);
+    persistent_data_ = std::exchange(other.persistent_data_, nullptr);
+    last_accesses_ = std::exchange(other.last_accesses_, {});
+    last_uses_ = std::exchange(other.last_uses_, {});
     return *this;
   }
 
   /// @brief Returns `false` if the buffer object does not refer to a valid
   /// buffer
-  [[nodiscard]] operator bool() noexcept
+  [[nodiscard]] explicit operator bool() const noexcept
   {
-    return !buffer_;
+    return buffer_ != nullptr;
   }
 
   /// @brief Gets a direct handle to the underlying VkBuffer
@@ -67,12 +86,22 @@ public:
     return buffer_;
   }
 
+  /// @brief Returns `true` if the buffer is mapped during its whole lifetime
+  [[nodiscard]] auto is_persistently_mapped() const noexcept -> bool
+  {
+    return persistent_data_ != nullptr;
+  }
+
   /**
    * @brief Map a buffer with host visible memory
    * @note: If cannot map to the buffer, returns nullptr
    */
   [[nodiscard]] auto map() noexcept -> void*
   {
+    if (persistent_data_) {
+      return persistent_data_;
+    }
+
     void* payload;
     if (vmaMapMemory(allocator_, allocation_, &payload) != VK_SUCCESS) {
       return nullptr;
@@ -83,7 +112,22 @@ public:
   /// @brief Unmap a buffer
   auto unmap() noexcept -> void
   {
-    vmaUnmapMemory(allocator_, allocation_);
+    if (!persistent_data_) {
+      vmaUnmapMemory(allocator_, allocation_);
+    }
+  }
+
+  /// @brief Flushes a range of non-coherent memory, no-op for coherent memory
+  auto flush(VkDeviceSize offset, VkDeviceSize size) noexcept -> void
+  {
+    vmaFlushAllocation(allocator_, allocation_, offset, size);
+  }
+
+  /// @brief Invalidates a range of non-coherent memory, no-op for coherent
+  /// memory
+  auto invalidate(VkDeviceSize offset, VkDeviceSize size) noexcept -> void
+  {
+    vmaInvalidateAllocation(allocator_, allocation_, offset, size);
   }
 
   [[nodiscard]] auto size() noexcept -> std::uint32_t
@@ -91,11 +135,28 @@ public:
     return size_;
   }
 
+  /// @brief Gets the latest accesses of the buffer by the submitted command
+  /// lists
+  [[nodiscard]] auto last_accesses() noexcept -> BufferAccesses&
+  {
+    return last_accesses_;
+  }
+
+  /// @brief Gets the timeline values of the latest submissions of every queue
+  /// that use the buffer
+  [[nodiscard]] auto last_uses() noexcept -> Timepoint&
+  {
+    return last_uses_;
+  }
+
 private:
   VmaAllocator allocator_ = nullptr;
   VkBuffer buffer_ = nullptr;
   VmaAllocation allocation_ = nullptr;
   std::uint32_t size_ = 0;
+  void* persistent_data_ = nullptr;
+  BufferAccesses last_accesses_;
+  Timepoint last_uses_{};
 };
 
 } // namespace beyond::graphics::vulkan
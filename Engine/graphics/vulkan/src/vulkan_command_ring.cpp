@@ -0,0 +1,193 @@
+#include "vulkan_command_ring.hpp"
+
+#include <beyond/utils/panic.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace beyond::graphics::vulkan {
+
+CommandRing::CommandRing(VkDevice device, std::uint32_t queue_family_index)
+    : device_{device}, queue_family_index_{queue_family_index}
+{
+  for (auto& frame : frames_) {
+    frame.command_pool = create_command_pool();
+
+    const VkCommandBufferAllocateInfo command_buffer_allocate_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext = nullptr,
+        .commandPool = frame.command_pool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1};
+    if (vkAllocateCommandBuffers(device_, &command_buffer_allocate_info,
+                                 &frame.command_buffer) != VK_SUCCESS) {
+      beyond::panic("Vulkan backend failed to allocate command buffer");
+    }
+  }
+
+  // The timeline starts at 0, which no submission waits on, so the first
+  // acquire of each frame does not block
+  const VkSemaphoreTypeCreateInfo semaphore_type_create_info{
+      .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+      .pNext = nullptr,
+      .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+      .initialValue = 0,
+  };
+  const VkSemaphoreCreateInfo semaphore_create_info{
+      .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+      .pNext = &semaphore_type_create_info,
+      .flags = 0,
+  };
+  if (vkCreateSemaphore(device_, &semaphore_create_info, nullptr,
+                        &timeline_) != VK_SUCCESS) {
+    beyond::panic("Vulkan backend failed to create timeline semaphore");
+  }
+}
+
+CommandRing::~CommandRing() noexcept
+{
+  destroy();
+}
+
+auto CommandRing::acquire() -> Frame&
+{
+  current_ = (current_ + 1) % frames_in_flight;
+  auto& frame = frames_[current_];
+
+  wait(frame.value);
+  if (vkResetCommandPool(device_, frame.command_pool, 0) != VK_SUCCESS) {
+    beyond::panic("Vulkan backend failed to reset command pool");
+  }
+  for (auto& pool : frame.secondary_pools) {
+    if (pool.used_count == 0) {
+      continue;
+    }
+    if (vkResetCommandPool(device_, pool.command_pool, 0) != VK_SUCCESS) {
+      beyond::panic("Vulkan backend failed to reset command pool");
+    }
+    pool.used_count = 0;
+  }
+
+  return frame;
+}
+
+auto CommandRing::set_recording_thread_count(std::uint32_t count) -> void
+{
+  wait(submitted_value_);
+  destroy_secondary_pools();
+  for (auto& frame : frames_) {
+    frame.secondary_pools.resize(count);
+    for (auto& pool : frame.secondary_pools) {
+      pool.command_pool = create_command_pool();
+    }
+  }
+}
+
+auto CommandRing::acquire_secondary(Frame& frame, std::uint32_t thread_index)
+    -> VkCommandBuffer
+{
+  auto& pool = frame.secondary_pools[thread_index];
+  if (pool.used_count == pool.command_buffers.size()) {
+    const VkCommandBufferAllocateInfo allocate_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext = nullptr,
+        .commandPool = pool.command_pool,
+        .level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+        .commandBufferCount = 1};
+    VkCommandBuffer command_buffer = nullptr;
+    if (vkAllocateCommandBuffers(device_, &allocate_info, &command_buffer) !=
+        VK_SUCCESS) {
+      beyond::panic("Vulkan backend failed to allocate command buffer");
+    }
+    pool.command_buffers.push_back(command_buffer);
+  }
+  return pool.command_buffers[pool.used_count++];
+}
+
+auto CommandRing::is_reached(std::uint64_t value) -> bool
+{
+  if (value <= completed_value_) {
+    return true;
+  }
+
+  std::uint64_t counter_value = 0;
+  if (vkGetSemaphoreCounterValue(device_, timeline_, &counter_value) !=
+      VK_SUCCESS) {
+    beyond::panic("Vulkan backend failed to read timeline semaphore");
+  }
+  mark_completed(counter_value);
+  return value <= counter_value;
+}
+
+auto CommandRing::wait(std::uint64_t value) -> void
+{
+  if (is_reached(value)) {
+    return;
+  }
+
+  const VkSemaphoreWaitInfo wait_info{
+      .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .semaphoreCount = 1,
+      .pSemaphores = &timeline_,
+      .pValues = &value,
+  };
+  if (vkWaitSemaphores(device_, &wait_info,
+                       std::numeric_limits<std::uint64_t>::max()) !=
+      VK_SUCCESS) {
+    beyond::panic("Vulkan backend failed to wait for timeline semaphore");
+  }
+  mark_completed(value);
+}
+
+auto CommandRing::mark_completed(std::uint64_t value) noexcept -> void
+{
+  auto completed_value = completed_value_.load();
+  while (completed_value < value &&
+         !completed_value_.compare_exchange_weak(completed_value, value)) {
+  }
+}
+
+auto CommandRing::create_command_pool() const -> VkCommandPool
+{
+  const VkCommandPoolCreateInfo create_info{
+      .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+      .queueFamilyIndex = queue_family_index_};
+
+  VkCommandPool command_pool = nullptr;
+  if (vkCreateCommandPool(device_, &create_info, nullptr, &command_pool) !=
+      VK_SUCCESS) {
+    beyond::panic("Vulkan backend failed to create command pool");
+  }
+  return command_pool;
+}
+
+auto CommandRing::destroy_secondary_pools() noexcept -> void
+{
+  for (auto& frame : frames_) {
+    for (auto& pool : frame.secondary_pools) {
+      vkDestroyCommandPool(device_, pool.command_pool, nullptr);
+    }
+    frame.secondary_pools.clear();
+  }
+}
+
+auto CommandRing::destroy() noexcept -> void
+{
+  if (!device_) {
+    return;
+  }
+
+  destroy_secondary_pools();
+  vkDestroySemaphore(device_, timeline_, nullptr);
+  for (auto& frame : frames_) {
+    // Command buffers are freed together with their pool
+    vkDestroyCommandPool(device_, frame.command_pool, nullptr);
+  }
+  device_ = nullptr;
+}
+
+} // namespace beyond::graphics::vulkan
@@ -0,0 +1,172 @@
+#pragma once
+
+#ifndef BEYOND_GRAPHICS_VULKAN_COMMAND_RING_HPP
+#define BEYOND_GRAPHICS_VULKAN_COMMAND_RING_HPP
+
+#include <volk.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace beyond::graphics::vulkan {
+
+/**
+ * @brief A ring of per-frame command pools that belongs to a queue, which
+ * tracks the progress of the queue with a timeline semaphore
+ *
+ * Every frame in flight owns a transient command pool and a primary command
+ * buffer allocated from that pool. Every submission signals the next value of
+ * the timeline, and acquiring a frame waits until the timeline reaches the
+ * value of its previous submission before resetting the pool. Thus no Vulkan
+ * object get created or destoryed on the submit path.
+ *
+ * Frames also own one pool of secondary command buffers per recording thread,
+ * so that threads record in parallel without locking.
+ *
+ * Checking and waiting for timeline values is thread-safe, since any thread
+ * that destroys resources may collect the ones that the GPU no longer uses.
+ */
+class CommandRing {
+public:
+  static constexpr std::uint32_t frames_in_flight = 2;
+
+  struct SecondaryPool {
+    VkCommandPool command_pool = nullptr;
+    std::vector<VkCommandBuffer> command_buffers;
+    std::size_t used_count = 0;
+  };
+
+  struct Frame {
+    VkCommandPool command_pool = nullptr;
+    VkCommandBuffer command_buffer = nullptr;
+    std::uint64_t value = 0; // Timeline value of the latest submission
+    std::vector<SecondaryPool> secondary_pools; // One per recording thread
+  };
+
+  CommandRing() = default;
+  CommandRing(VkDevice device, std::uint32_t queue_family_index);
+  ~CommandRing() noexcept;
+
+  CommandRing(const CommandRing&) = delete;
+  auto operator=(const CommandRing&) & -> CommandRing& = delete;
+
+  CommandRing(CommandRing&& other) noexcept
+      : device_{std::exchange(other.device_, nullptr)},
+        queue_family_index_{other.queue_family_index_},
+        frames_{std::exchange(other.frames_, {})},
+        current_{std::exchange(other.current_, 0)},
+        timeline_{std::exchange(other.timeline_, nullptr)},
+        submitted_value_{std::exchange(other.submitted_value_, 0)},
+        completed_value_{other.completed_value_.exchange(0)}
+  {
+  }
+
+  auto operator=(CommandRing&& other) & noexcept -> CommandRing&
+  {
+    destroy();
+    device_ = std::exchange(other.device_, nullptr);
+    queue_family_index_ = other.queue_family_index_;
+    frames_ = std::exchange(other.frames_, {});
+    current_ = std::exchange(other.current_, 0);
+    timeline_ = std::exchange(other.timeline_, nullptr);
+    submitted_value_ = std::exchange(other.submitted_value_, 0);
+    completed_value_ = other.completed_value_.exchange(0);
+    return *this;
+  }
+
+  /**
+   * @brief Advances to the next frame of the ring
+   *
+   * Blocks until the previous submission of that frame retires, then resets
+   * its command pool. The returned command buffer is in the initial state and
+   * ready to be recorded.
+   */
+  [[nodiscard]] auto acquire() -> Frame&;
+
+  /// @brief Gets the index of the frame returned by the last `acquire`
+  [[nodiscard]] auto current_index() const noexcept -> std::uint32_t
+  {
+    return current_;
+  }
+
+  /**
+   * @brief Sets the number of threads that record secondary command buffers
+   *
+   * Waits until all the submitted work completes before replacing the
+   * secondary pools.
+   */
+  auto set_recording_thread_count(std::uint32_t count) -> void;
+
+  /**
+   * @brief Gets a secondary command buffer of `frame` for the thread of
+   * `thread_index`
+   *
+   * Buffers are reused after their frame gets acquired again. Different
+   * threads may call this function concurrently with their own indices.
+   */
+  [[nodiscard]] auto acquire_secondary(Frame& frame, std::uint32_t thread_index)
+      -> VkCommandBuffer;
+
+  /**
+   * @brief Assigns the next timeline value to the submission of `frame`
+   * @return The value that the submission must signal
+   */
+  auto commit(Frame& frame) noexcept -> std::uint64_t
+  {
+    frame.value = ++submitted_value_;
+    return frame.value;
+  }
+
+  [[nodiscard]] auto timeline() const noexcept -> VkSemaphore
+  {
+    return timeline_;
+  }
+
+  /// @brief Gets the value of the latest submission
+  [[nodiscard]] auto submitted_value() const noexcept -> std::uint64_t
+  {
+    return submitted_value_;
+  }
+
+  /**
+   * @brief Checks if the timeline reached `value`
+   *
+   * Only reads the counter of the semaphore when `value` is newer than the
+   * last value known to be reached.
+   */
+  [[nodiscard]] auto is_reached(std::uint64_t value) -> bool;
+
+  /// @brief Blocks until the timeline reaches `value`
+  auto wait(std::uint64_t value) -> void;
+
+  /// @brief Gets the latest value known to be reached without querying the
+  /// device
+  [[nodiscard]] auto completed_value() const noexcept -> std::uint64_t
+  {
+    return completed_value_;
+  }
+
+private:
+  VkDevice device_ = nullptr;
+  std::uint32_t queue_family_index_ = 0;
+  std::array<Frame, frames_in_flight> frames_{};
+  std::uint32_t current_ = 0;
+
+  VkSemaphore timeline_ = nullptr;
+  std::uint64_t submitted_value_ = 0;
+  std::atomic<std::uint64_t> completed_value_ = 0;
+
+  /// @brief Raises `completed_value_` to `value` if it is lower
+  auto mark_completed(std::uint64_t value) noexcept -> void;
+  [[nodiscard]] auto create_command_pool() const -> VkCommandPool;
+  auto destroy_secondary_pools() noexcept -> void;
+  auto destroy() noexcept -> void;
+};
+
+} // namespace beyond::graphics::vulkan
+
+#endif // BEYOND_GRAPHICS_VULKAN_COMMAND_RING_HPP
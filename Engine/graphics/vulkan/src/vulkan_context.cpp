@@ -2,11 +2,18 @@
 #include <beyond/utils/bit_cast.hpp>
 
 #include "vulkan_context.hpp"
-#include "vulkan_shader_module.hpp"
+#include "vulkan_embedded_shaders.hpp"
 #include "vulkan_utils.hpp"
 
 #include <fmt/format.h>
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <variant>
+
 #define BAIL_ON_BAD_RESULT(result)                                             \
   if (VK_SUCCESS != (result)) {                                                \
     fprintf(stderr, "Failure at %u %s\n", __LINE__, __FILE__);                 \
@@ -19,6 +26,7 @@ using vulkan::QueueFamilyIndices;
 namespace {
 
 constexpr std::array validation_layers = {"VK_LAYER_KHRONOS_validation"};
+// Only required by contexts that present to a surface
 constexpr std::array device_extensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 
 #ifdef BEYOND_VULKAN_ENABLE_VALIDATION_LAYER
@@ -46,6 +54,8 @@ check_device_extension_support(VkPhysicalDevice device) noexcept -> bool
 }
 
 // Higher is better, negative means not suitable
+// A `nullptr` surface rates the device for a headless context, which only
+// needs a compute queue
 [[nodiscard]] auto rate_physical_device(VkPhysicalDevice device,
                                         VkSurfaceKHR surface) noexcept -> int
 {
@@ -57,29 +67,49 @@ check_device_extension_support(VkPhysicalDevice device) noexcept -> bool
     return failing_score;
   }
 
-  // If not support extension, return -1000
-  if (!check_device_extension_support(device)) {
-    return failing_score;
-  }
+  if (surface != nullptr) {
+    // If not support extension, return -1000
+    if (!check_device_extension_support(device)) {
+      return failing_score;
+    }
 
-  // If swapchain not adequate, return -1000
-  const auto swapchain_support =
-      vulkan::query_swapchain_support(device, surface);
-  if (swapchain_support.formats.empty() ||
-      swapchain_support.present_modes.empty()) {
-    return failing_score;
+    // If swapchain not adequate, return -1000
+    const auto swapchain_support =
+        vulkan::query_swapchain_support(device, surface);
+    if (swapchain_support.formats.empty() ||
+        swapchain_support.present_modes.empty()) {
+      return failing_score;
+    }
   }
 
   VkPhysicalDeviceProperties properties;
   vkGetPhysicalDeviceProperties(device, &properties);
 
-  VkPhysicalDeviceFeatures features;
-  vkGetPhysicalDeviceFeatures(device, &features);
+  // Submissions are tracked by timeline semaphores, which are core since
+  // Vulkan 1.2 but still a feature to check. There is no fallback for older
+  // devices, see `VulkanContext`.
+  if (properties.apiVersion < VK_API_VERSION_1_2) {
+    return failing_score;
+  }
+  VkPhysicalDeviceVulkan12Features vulkan12_features{};
+  vulkan12_features.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+  VkPhysicalDeviceFeatures2 features{};
+  features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+  features.pNext = &vulkan12_features;
+  vkGetPhysicalDeviceFeatures2(device, &features);
+  if (vulkan12_features.timelineSemaphore != VK_TRUE) {
+    return failing_score;
+  }
 
-  // Biased toward discrete GPU
+  // Biased toward discrete GPU, while software implementations such as
+  // lavapipe are still suitable
   int score = 0;
   if (properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) {
     score += 100;
+  } else if (properties.deviceType ==
+             VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU) {
+    score += 10;
   }
 
   return score;
@@ -115,7 +145,8 @@ constexpr auto populate_debug_messenger_create_info() noexcept
 }
 #endif
 
-[[nodiscard]] auto create_instance(const beyond::Window& window) noexcept
+// A `nullptr` window creates an instance without surface extensions
+[[nodiscard]] auto create_instance(const beyond::Window* window) noexcept
     -> VkInstance;
 
 #ifdef BEYOND_VULKAN_ENABLE_VALIDATION_LAYER
@@ -127,9 +158,129 @@ constexpr auto populate_debug_messenger_create_info() noexcept
                                         VkSurfaceKHR surface) noexcept
     -> VkPhysicalDevice;
 
-[[nodiscard]] auto
-create_logical_device(VkPhysicalDevice pd,
-                      const QueueFamilyIndices& indices) noexcept -> VkDevice;
+// Whether the loader and a device provide what a headless context needs,
+// which lets the headless factory fail without panicking
+[[nodiscard]] auto supports_headless_context() noexcept -> bool;
+
+[[nodiscard]] auto create_logical_device(VkPhysicalDevice pd,
+                                         const QueueFamilyIndices& indices,
+                                         bool headless) noexcept -> VkDevice;
+
+auto begin_command_buffer(VkCommandBuffer command_buffer) -> void
+{
+  const VkCommandBufferBeginInfo command_buffer_begin_info = {
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+      .pNext = nullptr,
+      .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+      .pInheritanceInfo = nullptr};
+
+  if (vkBeginCommandBuffer(command_buffer, &command_buffer_begin_info) !=
+      VK_SUCCESS) {
+    beyond::panic("Vulkan backend failed to begin command buffer");
+  }
+}
+
+auto begin_secondary_command_buffer(VkCommandBuffer command_buffer) -> void
+{
+  // Compute work does not inherit any render pass
+  const VkCommandBufferInheritanceInfo inheritance_info = {
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+      .pNext = nullptr,
+      .renderPass = nullptr,
+      .subpass = 0,
+      .framebuffer = nullptr,
+      .occlusionQueryEnable = VK_FALSE,
+      .queryFlags = 0,
+      .pipelineStatistics = 0};
+  const VkCommandBufferBeginInfo begin_info = {
+      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+      .pNext = nullptr,
+      .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+      .pInheritanceInfo = &inheritance_info};
+
+  if (vkBeginCommandBuffer(command_buffer, &begin_info) != VK_SUCCESS) {
+    beyond::panic("Vulkan backend failed to begin command buffer");
+  }
+}
+
+// Makes all the writes of earlier dispatches and copies on the same queue
+// visible to later ones, for explicit barriers of command lists
+auto barrier_between_commands(VkCommandBuffer command_buffer) noexcept -> void
+{
+  const VkMemoryBarrier barrier{
+      .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask =
+          VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT |
+                       VK_ACCESS_TRANSFER_READ_BIT |
+                       VK_ACCESS_TRANSFER_WRITE_BIT};
+  const VkPipelineStageFlags stages =
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+  vkCmdPipelineBarrier(command_buffer, stages, stages, 0, 1, &barrier, 0,
+                       nullptr, 0, nullptr);
+}
+
+[[nodiscard]] constexpr auto to_shader_access(BufferAccess access) noexcept
+    -> VkAccessFlags
+{
+  switch (access) {
+  case BufferAccess::read:
+    return VK_ACCESS_SHADER_READ_BIT;
+  case BufferAccess::write:
+    return VK_ACCESS_SHADER_WRITE_BIT;
+  case BufferAccess::read_write:
+    break;
+  }
+  return VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+}
+
+// Orders a transfer after the earlier commands of the same queue that access
+// its buffers. Work of other queues is ordered by timeline waits instead.
+// `runs_compute` tells whether the queue also executes dispatches.
+auto barrier_before_transfer(VkCommandBuffer command_buffer,
+                             bool runs_compute) noexcept -> void
+{
+  VkPipelineStageFlags src_stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+  VkAccessFlags src_access = VK_ACCESS_TRANSFER_WRITE_BIT;
+  if (runs_compute) {
+    src_stages |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    src_access |= VK_ACCESS_SHADER_WRITE_BIT;
+  }
+
+  const VkMemoryBarrier barrier{
+      .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask = src_access,
+      .dstAccessMask =
+          VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT};
+  vkCmdPipelineBarrier(command_buffer, src_stages,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0,
+                       nullptr, 0, nullptr);
+}
+
+// Makes the result of a transfer visible to later dispatches and copies of
+// command lists on the same queue, which do not track the accesses of
+// transfers
+auto barrier_after_transfer(VkCommandBuffer command_buffer,
+                            bool runs_compute) noexcept -> void
+{
+  if (!runs_compute) {
+    return;
+  }
+
+  const VkMemoryBarrier barrier{
+      .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+      .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT |
+                       VK_ACCESS_TRANSFER_READ_BIT |
+                       VK_ACCESS_TRANSFER_WRITE_BIT};
+  vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+                           VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
 
 } // anonymous namespace
 
@@ -138,12 +289,22 @@ namespace beyond::graphics::vulkan {
 [[nodiscard]] auto create_vulkan_context(Window& window) noexcept
     -> std::unique_ptr<Context>
 {
-  return std::make_unique<VulkanContext>(window);
+  return std::make_unique<VulkanContext>(&window);
 }
 
-VulkanContext::VulkanContext(Window& window)
+[[nodiscard]] auto create_vulkan_headless_context() noexcept
+    -> std::unique_ptr<Context>
 {
-  std::puts("Vulkan Graphics backend");
+  if (!supports_headless_context()) {
+    return nullptr;
+  }
+  return std::make_unique<VulkanContext>(nullptr);
+}
+
+VulkanContext::VulkanContext(Window* window)
+{
+  std::puts(window != nullptr ? "Vulkan Graphics backend"
+                              : "Vulkan Graphics backend (headless)");
 
   if (volkInitialize() != VK_SUCCESS) {
     panic("Cannot find a Vulkan Loader in the system!");
@@ -152,15 +313,23 @@ VulkanContext::VulkanContext(Window& window)
   instance_ = create_instance(window);
   volkLoadInstance(instance_);
 
-  window.create_vulkan_surface(instance_, nullptr, surface_);
+  if (window != nullptr) {
+    window->create_vulkan_surface(instance_, nullptr, surface_);
+  }
 
 #ifdef BEYOND_VULKAN_ENABLE_VALIDATION_LAYER
   debug_messager_ = create_debug_messager(instance_);
 #endif
 
   physical_device_ = pick_physical_device(instance_, surface_);
+  {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physical_device_, &properties);
+    max_push_constant_size_ = properties.limits.maxPushConstantsSize;
+  }
   queue_family_indices_ = *find_queue_families(physical_device_, surface_);
-  device_ = create_logical_device(physical_device_, queue_family_indices_);
+  device_ = create_logical_device(physical_device_, queue_family_indices_,
+                                  surface_ == nullptr);
   volkLoadDevice(device_);
 
   const auto get_device_queue = [this](std::uint32_t family_index,
@@ -169,9 +338,9 @@ VulkanContext::VulkanContext(Window& window)
     vkGetDeviceQueue(this->device_, family_index, index, &queue);
     return queue;
   };
-  graphics_queue_ = get_device_queue(queue_family_indices_.graphics_family, 0);
-  present_queue_ = get_device_queue(queue_family_indices_.present_family, 0);
-  compute_queue_ = get_device_queue(queue_family_indices_.compute_family, 0);
+  if (queue_family_indices_.present_family) {
+    present_queue_ = get_device_queue(*queue_family_indices_.present_family, 0);
+  }
 
   VmaAllocatorCreateInfo allocator_info{};
   allocator_info.physicalDevice = physical_device_;
@@ -179,13 +348,60 @@ VulkanContext::VulkanContext(Window& window)
   if (vmaCreateAllocator(&allocator_info, &allocator_) != VK_SUCCESS) {
     beyond::panic("Cannot create an allocator for vulkan");
   }
+
+  pipeline_cache_ =
+      PipelineCache{physical_device_, device_, pipeline_cache_path};
+
+  // Queue types that share a family also share a queue. Without a graphics
+  // family, graphics work goes to the compute queue.
+  const std::array families = {
+      queue_family_indices_.graphics_family.value_or(
+          queue_family_indices_.compute_family),
+      queue_family_indices_.compute_family,
+      queue_family_indices_.transfer_family};
+  queues_.reserve(queue_type_count);
+  for (std::uint32_t type = 0; type < queue_type_count; ++type) {
+    const auto family = families[type];
+    const auto existing =
+        std::find_if(queues_.begin(), queues_.end(), [&](const Queue& queue) {
+          return queue.family_index == family;
+        });
+    if (existing != queues_.end()) {
+      queue_slots_[type] = to_u32(existing - queues_.begin());
+      continue;
+    }
+
+    queue_slots_[type] = to_u32(queues_.size());
+    queues_.push_back(Queue{.queue = get_device_queue(family, 0),
+                            .family_index = family,
+                            .command_ring = CommandRing{device_, family}});
+    queue_families_.push_back(family);
+  }
+
+  descriptor_set_cache_ = DescriptorSetCache{device_};
+  layout_cache_ = LayoutCache{device_};
+  shader_module_cache_ = ShaderModuleCache{device_};
+  staging_ring_ = StagingRing{allocator_};
 } // namespace beyond::graphics::vulkan
 
 VulkanContext::~VulkanContext() noexcept
 {
+  // Finishes the pending compilations, which use the caches of the context
+  compile_pool_ = nullptr;
+  vkDeviceWaitIdle(device_);
+
+  recording_pool_ = nullptr;
+  // Every timeline is reached after the device becomes idle
+  collect_garbage();
   swapchains_pool_.clear();
-  buffers_pool_.clear();
+  buffers_.clear();
   compute_pipelines_pool_.clear();
+  layout_cache_ = LayoutCache{};
+  shader_module_cache_ = ShaderModuleCache{};
+  pipeline_cache_ = PipelineCache{};
+  queues_.clear();
+  descriptor_set_cache_ = DescriptorSetCache{};
+  staging_ring_ = StagingRing{};
 
   vmaDestroyAllocator(allocator_);
 
@@ -201,6 +417,10 @@ VulkanContext::~VulkanContext() noexcept
 
 [[nodiscard]] auto VulkanContext::create_swapchain() -> Swapchain
 {
+  if (surface_ == nullptr) {
+    beyond::panic("Cannot create a swapchain from a headless context");
+  }
+
   const auto index = swapchains_pool_.size();
 
   if (index >= 1) {
@@ -217,21 +437,20 @@ VulkanContext::create_buffer(const BufferCreateInfo& create_info) -> Buffer
 {
   // TODO(lesley): error handling
 
-  const auto index = static_cast<Buffer::Index>(buffers_pool_.size());
-
-  if (Buffer::is_overflow(index)) {
-    beyond::panic("Created too many buffers");
-  }
-
   const VkBufferCreateInfo buffer_info{
       .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
       .pNext = nullptr,
       .flags = 0,
       .size = create_info.size,
-      .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-      .sharingMode = {},
-      .queueFamilyIndexCount = 0,
-      .pQueueFamilyIndices = nullptr,
+      .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+               VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+               VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+      // Buffers are shared between the queues without ownership transfers
+      .sharingMode = queue_families_.size() > 1 ? VK_SHARING_MODE_CONCURRENT
+                                                : VK_SHARING_MODE_EXCLUSIVE,
+      .queueFamilyIndexCount =
+          queue_families_.size() > 1 ? to_u32(queue_families_.size()) : 0,
+      .pQueueFamilyIndices = queue_families_.data(),
   };
 
   VmaAllocationCreateInfo alloc_info{};
@@ -249,210 +468,887 @@ VulkanContext::create_buffer(const BufferCreateInfo& create_info) -> Buffer
     alloc_info.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
     break;
   }
+  // VMA leaves pMappedData null if the memory is not host visible
+  if (create_info.persistently_mapped) {
+    alloc_info.flags |= VMA_ALLOCATION_CREATE_MAPPED_BIT;
+  }
 
   VkBuffer buffer;
   VmaAllocation allocation;
+  VmaAllocationInfo allocation_info{};
   if (vmaCreateBuffer(allocator_, &buffer_info, &alloc_info, &buffer,
-                      &allocation, nullptr) != VK_SUCCESS) {
+                      &allocation, &allocation_info) != VK_SUCCESS) {
     beyond::panic("Vulkan backend failed to allocate a buffer");
   }
 
-  buffers_pool_.emplace_back(allocator_, buffer, allocation, create_info.size);
-  return Buffer{index};
+  std::scoped_lock lock{resource_mutex_};
+  const auto handle =
+      buffers_.emplace(allocator_, buffer, allocation, create_info.size,
+                       allocation_info.pMappedData);
+  if (!buffers_.contains(handle)) {
+    vmaDestroyBuffer(allocator_, buffer, allocation);
+    beyond::panic("Created too many buffers");
+  }
+  return handle;
 }
 
 auto VulkanContext::destory_buffer(Buffer& buffer_handle) -> void
 {
-  const auto index = buffer_handle.index();
+  {
+    std::scoped_lock lock{resource_mutex_};
+    auto buffer = buffers_.erase(buffer_handle);
+    if (!buffer) {
+      return;
+    }
 
-  if (index >= buffers_pool_.size() || !buffers_pool_[index]) {
-    return;
+    // Submissions in flight may still use the buffer, so it goes through the
+    // deletion queue
+    destroyed_buffers_.push_back(std::move(*buffer));
+    ++garbage_count_;
   }
-
-  buffers_pool_[index] = VulkanBuffer{};
+  collect_garbage();
 }
 
 [[nodiscard]] auto VulkanContext::map_memory_impl(Buffer buffer_handle) noexcept
     -> MappingInfo
 {
-  if (buffers_pool_.size() < buffer_handle.index()) {
+  std::shared_lock lock{resource_mutex_};
+  auto* buffer = buffers_.try_get(buffer_handle);
+  if (buffer == nullptr) {
     return {nullptr, 0};
   }
 
-  auto& buffer = buffers_pool_[buffer_handle.index()];
-  return {buffer.map(), buffer.size()};
+  return {buffer->map(), buffer->size(), buffer->is_persistently_mapped()};
 }
 
 auto VulkanContext::unmap_memory_impl(Buffer buffer_handle) noexcept -> void
 {
-  if (buffers_pool_.size() < buffer_handle.index()) {
+  std::shared_lock lock{resource_mutex_};
+  auto* buffer = buffers_.try_get(buffer_handle);
+  if (buffer == nullptr) {
     // TODO(llai): error handling in unmap_memory?
     beyond::panic("unmap an invalid buffer handle");
   }
 
-  return buffers_pool_[buffer_handle.index()].unmap();
+  return buffer->unmap();
+}
+
+auto VulkanContext::flush_buffer(Buffer buffer_handle, std::size_t offset,
+                                 std::size_t size) -> void
+{
+  std::shared_lock lock{resource_mutex_};
+  get_buffer(buffer_handle)
+      .flush(offset, size == whole_size ? VK_WHOLE_SIZE : size);
+}
+
+auto VulkanContext::invalidate_buffer(Buffer buffer_handle, std::size_t offset,
+                                      std::size_t size) -> void
+{
+  std::shared_lock lock{resource_mutex_};
+  get_buffer(buffer_handle)
+      .invalidate(offset, size == whole_size ? VK_WHOLE_SIZE : size);
+}
+
+auto VulkanContext::get_buffer(Buffer buffer_handle) -> VulkanBuffer&
+{
+  auto* buffer = buffers_.try_get(buffer_handle);
+  if (buffer == nullptr) {
+    beyond::panic("Vulkan backend refers to an invalid buffer handle");
+  }
+  return *buffer;
 }
 
 [[nodiscard]] auto VulkanContext::create_compute_pipeline(
     const ComputePipelineCreateInfo& create_info) -> ComputePipeline
 {
-  const auto index = compute_pipelines_pool_.size();
-  compute_pipelines_pool_.emplace_back(
-      VulkanPipeline::create_compute(create_info, device_));
+  auto pipeline = compile_compute_pipeline(create_info);
 
-  return ComputePipeline{static_cast<ComputePipeline::UnderlyingType>(index)};
+  std::scoped_lock lock{resource_mutex_};
+  return add_pipeline(std::move(pipeline));
 }
 
-auto VulkanContext::submit(gsl::span<SubmitInfo> info) -> void
+[[nodiscard]] auto VulkanContext::create_compute_pipelines(
+    gsl::span<const ComputePipelineCreateInfo> create_infos)
+    -> std::vector<ComputePipeline>
 {
-  const auto& pipeline = compute_pipelines_pool_[info[0].pipeline.get()];
+  const auto count = static_cast<std::size_t>(create_infos.size());
+  std::vector<std::optional<VulkanPipeline>> compiled(count);
+  compile_pool().parallel_for(count, [&](std::size_t index, std::uint32_t) {
+    compiled[index] = compile_compute_pipeline(
+        create_infos[static_cast<std::ptrdiff_t>(index)]);
+  });
+
+  std::scoped_lock lock{resource_mutex_};
+  std::vector<ComputePipeline> pipelines;
+  pipelines.reserve(count);
+  for (auto& pipeline : compiled) {
+    pipelines.push_back(add_pipeline(std::move(pipeline)));
+  }
+  return pipelines;
+}
 
-  const VkDescriptorPoolSize descriptor_pool_size{
-      .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = 2};
+[[nodiscard]] auto VulkanContext::create_compute_pipelines_async(
+    gsl::span<const ComputePipelineCreateInfo> create_infos)
+    -> std::vector<ComputePipeline>
+{
+  std::vector<ComputePipeline> pipelines;
+  pipelines.reserve(static_cast<std::size_t>(create_infos.size()));
+  {
+    std::scoped_lock lock{resource_mutex_};
+    for (std::ptrdiff_t i = 0; i < create_infos.size(); ++i) {
+      pipelines.push_back(add_pipeline(std::nullopt));
+    }
+  }
 
-  const VkDescriptorPoolCreateInfo descriptor_pool_create_info = {
-      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-      .pNext = nullptr,
-      .flags = 0,
-      .maxSets = 1,
-      .poolSizeCount = 1,
-      .pPoolSizes = &descriptor_pool_size};
+  auto& pool = compile_pool();
+  for (std::size_t i = 0; i < pipelines.size(); ++i) {
+    const auto& create_info = create_infos[static_cast<std::ptrdiff_t>(i)];
+    // The task outlives `create_infos`, so it owns copies of the spans
+    pool.enqueue([this, create_info, handle = pipelines[i],
+                  code = std::vector<std::uint32_t>(create_info.code.begin(),
+                                                    create_info.code.end()),
+                  constants = std::vector<SpecializationConstant>(
+                      create_info.specialization_constants.begin(),
+                      create_info.specialization_constants.end())](
+                     std::uint32_t) {
+      auto owned_info = create_info;
+      owned_info.code = code;
+      owned_info.specialization_constants = constants;
+      auto pipeline = compile_compute_pipeline(owned_info);
+      bool dropped = false;
+      {
+        std::scoped_lock lock{resource_mutex_};
+        if (auto* slot = compute_pipelines_pool_.try_get(handle);
+            slot != nullptr) {
+          *slot = std::move(pipeline);
+        } else {
+          // A pipeline destroyed before it gets ready still holds references
+          // to the cached shader module and layouts
+          destroyed_pipelines_.push_back(std::move(pipeline));
+          ++garbage_count_;
+          dropped = true;
+        }
+      }
+      pipeline_ready_.notify_all();
+      if (dropped) {
+        collect_garbage();
+      }
+    });
+  }
+  return pipelines;
+}
 
-  VkDescriptorPool descriptor_pool;
-  if (vkCreateDescriptorPool(device_, &descriptor_pool_create_info, nullptr,
-                             &descriptor_pool) != VK_SUCCESS) {
-    beyond::panic("Vulkan backend failed to create descriptor pool");
+[[nodiscard]] auto VulkanContext::is_pipeline_ready(ComputePipeline pipeline)
+    -> bool
+{
+  std::shared_lock lock{resource_mutex_};
+  const auto* slot = compute_pipelines_pool_.try_get(pipeline);
+  if (slot == nullptr) {
+    beyond::panic("Vulkan backend queries an invalid pipeline handle");
   }
+  return slot->has_value();
+}
 
-  const auto descriptor_set_layout = pipeline.descriptor_set_layout();
+[[nodiscard]] auto VulkanContext::workgroup_size(ComputePipeline pipeline)
+    -> std::array<std::uint32_t, 3>
+{
+  std::shared_lock lock{resource_mutex_};
+  // The size comes from the reflection of the shader, so pending pipelines
+  // must finish first
+  const std::optional<VulkanPipeline>* slot = nullptr;
+  pipeline_ready_.wait(lock, [&]() {
+    slot = compute_pipelines_pool_.try_get(pipeline);
+    return slot == nullptr || slot->has_value();
+  });
+  if (slot == nullptr) {
+    beyond::panic("Vulkan backend queries an invalid pipeline handle");
+  }
+  return (*slot)->workgroup_size();
+}
 
-  const VkDescriptorSetAllocateInfo descriptor_set_allocate_info{
-      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-      .pNext = nullptr,
-      .descriptorPool = descriptor_pool,
-      .descriptorSetCount = 1,
-      .pSetLayouts = &descriptor_set_layout};
+auto VulkanContext::destroy_compute_pipeline(ComputePipeline pipeline_handle)
+    -> void
+{
+  {
+    std::scoped_lock lock{resource_mutex_};
+    auto slot = compute_pipelines_pool_.erase(pipeline_handle);
+    // Pipelines that still compile get dropped by their compilation task
+    if (!slot || !slot->has_value()) {
+      return;
+    }
 
-  VkDescriptorSet descriptor_set;
-  if (vkAllocateDescriptorSets(device_, &descriptor_set_allocate_info,
-                               &descriptor_set) != VK_SUCCESS) {
-    beyond::panic("Vulkan backend failed to allocate descriptor set");
+    // Submissions in flight may still use the pipeline, so it goes through
+    // the deletion queue
+    destroyed_pipelines_.push_back(std::move(**slot));
+    ++garbage_count_;
   }
+  collect_garbage();
+}
 
-  const auto in_handle = info[0].input;
-  const auto out_handle = info[0].output;
-  const auto buffer_size = info[0].buffer_size;
+auto VulkanContext::compile_compute_pipeline(
+    const ComputePipelineCreateInfo& create_info) -> VulkanPipeline
+{
+  const ShaderModule* shader = nullptr;
+  {
+    std::scoped_lock lock{shader_module_mutex_};
+    auto code = create_info.code;
+    if (code.empty()) {
+      code = find_embedded_shader("copy.comp");
+    }
+    // Falls back to the compiled shader next to the executable if it is not
+    // embedded
+    if (code.empty()) {
+      if (default_shader_.size() == 0) {
+        default_shader_ = MappedFile{"shaders/copy.comp.spv"};
+      }
+      code = as_spirv(default_shader_.bytes());
+    }
+    // The pipeline holds a reference to the module, which keeps it alive
+    // without the lock
+    shader = &shader_module_cache_.get(code);
+  }
 
-  auto& in_buffer = buffers_pool_[in_handle.index()];
-  const auto in_buffer_raw = in_buffer.vkbuffer();
+  const auto& reflection = shader->reflection;
+  const auto push_constant_size =
+      std::max(create_info.push_constant_size, reflection.push_constant_size);
 
-  auto& out_buffer = buffers_pool_[out_handle.index()];
-  const auto out_buffer_raw = out_buffer.vkbuffer();
+  if (push_constant_size % 4 != 0 ||
+      push_constant_size > max_push_constant_size_) {
+    beyond::panic(fmt::format(
+        "Vulkan backend supports push constants of up to {} bytes in "
+        "multiples of 4, but got {}",
+        max_push_constant_size_, push_constant_size));
+  }
 
-  const VkDescriptorBufferInfo in_descriptor_buffer_info{
-      .buffer = in_buffer_raw,
-      .offset = 0,
-      .range = VK_WHOLE_SIZE,
-  };
+  const auto bindings = VulkanPipeline::layout_bindings(reflection);
+  PipelineLayout layout;
+  {
+    std::scoped_lock lock{layout_mutex_};
+    layout = layout_cache_.get(bindings, push_constant_size);
+  }
+
+  // Compiles without holding the lock, since pipeline caches are internally
+  // synchronized
+  return VulkanPipeline::create_compute(create_info, *shader, layout, device_,
+                                        pipeline_cache_.vkcache());
+}
+
+auto VulkanContext::compile_pool() -> WorkerPool&
+{
+  std::scoped_lock lock{compile_pool_mutex_};
+  if (compile_pool_ == nullptr) {
+    compile_pool_ = std::make_unique<WorkerPool>(
+        std::max(std::thread::hardware_concurrency(), 1u));
+  }
+  return *compile_pool_;
+}
+
+auto VulkanContext::add_pipeline(std::optional<VulkanPipeline> pipeline)
+    -> ComputePipeline
+{
+  const auto handle = compute_pipelines_pool_.emplace(std::move(pipeline));
+  if (!compute_pipelines_pool_.contains(handle)) {
+    beyond::panic("Created too many pipelines");
+  }
+  return handle;
+}
+
+auto VulkanContext::are_pipelines_ready(
+    gsl::span<const CommandList> command_lists) const -> bool
+{
+  for (const auto& command_list : command_lists) {
+    for (const auto& command : command_list.commands()) {
+      const auto* bind = std::get_if<BindPipelineCommand>(&command);
+      if (bind == nullptr) {
+        continue;
+      }
+      // Invalid handles are left for the recording to report
+      const auto* slot = compute_pipelines_pool_.try_get(bind->pipeline);
+      if (slot != nullptr && !slot->has_value()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+auto VulkanContext::used_buffers(gsl::span<const CommandList> command_lists)
+    -> std::vector<VulkanBuffer*>
+{
+  std::vector<VulkanBuffer*> buffers;
+  for (const auto& command_list : command_lists) {
+    for (const auto& command : command_list.commands()) {
+      if (const auto* bind = std::get_if<BindBuffersCommand>(&command)) {
+        for (const auto& binding : command_list.bindings(*bind)) {
+          buffers.push_back(&get_buffer(binding.buffer));
+        }
+      } else if (const auto* copy = std::get_if<CopyBufferCommand>(&command)) {
+        buffers.push_back(&get_buffer(copy->src));
+        buffers.push_back(&get_buffer(copy->dst));
+      }
+    }
+  }
+  std::sort(buffers.begin(), buffers.end());
+  buffers.erase(std::unique(buffers.begin(), buffers.end()), buffers.end());
+  return buffers;
+}
+
+auto VulkanContext::set_recording_thread_count(std::uint32_t count) -> void
+{
+  // Joins the old threads before creating new ones
+  recording_pool_ = nullptr;
+  if (count > 1) {
+    recording_pool_ = std::make_unique<WorkerPool>(count);
+  }
+  queue_of(QueueType::compute)
+      .command_ring.set_recording_thread_count(count > 1 ? count : 0);
+}
+
+auto VulkanContext::submit_impl(gsl::span<const CommandList> command_lists)
+    -> SubmitToken
+{
+  if (std::all_of(command_lists.begin(), command_lists.end(),
+                  [](const CommandList& list) { return list.empty(); })) {
+    return SubmitToken{};
+  }
 
-  const VkDescriptorBufferInfo out_descriptor_buffer_info{
-      .buffer = out_buffer_raw,
-      .offset = 0,
-      .range = VK_WHOLE_SIZE,
+  collect_garbage();
+  std::shared_lock lock{resource_mutex_};
+  // Bound pipelines that still compile asynchronously must finish first
+  pipeline_ready_.wait(lock,
+                       [&]() { return are_pipelines_ready(command_lists); });
+  const auto buffers = used_buffers(command_lists);
+
+  auto& frame = acquire_frame(QueueType::compute);
+  const auto command_buffer = frame.command_buffer;
+  begin_command_buffer(command_buffer);
+
+  // Lists are ordered after earlier lists and submissions of the queue by the
+  // last accesses of their buffers
+  const auto list_count = static_cast<std::size_t>(command_lists.size());
+  if (recording_pool_ == nullptr || list_count == 1) {
+    for (std::size_t i = 0; i < list_count; ++i) {
+      HazardTracker hazard_tracker;
+      record_commands(command_buffer,
+                      command_lists[static_cast<std::ptrdiff_t>(i)],
+                      hazard_tracker);
+      hazard_tracker.commit();
+    }
+    return submit_frame(QueueType::compute, frame, buffers);
+  }
+
+  // Every list goes to a secondary command buffer from the pool of the thread
+  // that records it, and the primary command buffer executes them in order
+  auto& command_ring = queue_of(QueueType::compute).command_ring;
+  std::vector<VkCommandBuffer> secondaries(list_count);
+  std::vector<HazardTracker> hazard_trackers(list_count, HazardTracker{true});
+  recording_pool_->parallel_for(
+      list_count, [&](std::size_t index, std::uint32_t thread_index) {
+        const auto secondary =
+            command_ring.acquire_secondary(frame, thread_index);
+        begin_secondary_command_buffer(secondary);
+        record_commands(secondary,
+                        command_lists[static_cast<std::ptrdiff_t>(index)],
+                        hazard_trackers[index]);
+        if (vkEndCommandBuffer(secondary) != VK_SUCCESS) {
+          beyond::panic("Vulkan backend failed to end command buffer");
+        }
+        secondaries[index] = secondary;
+      });
+
+  for (std::size_t i = 0; i < list_count; ++i) {
+    hazard_trackers[i].flush_entry(command_buffer);
+    vkCmdExecuteCommands(command_buffer, 1, &secondaries[i]);
+    hazard_trackers[i].commit();
+  }
+  return submit_frame(QueueType::compute, frame, buffers);
+}
+
+auto VulkanContext::record_commands(VkCommandBuffer command_buffer,
+                                    const CommandList& command_list,
+                                    HazardTracker& hazard_tracker) -> void
+{
+  const VulkanPipeline* pipeline = nullptr;
+  std::vector<VkDescriptorBufferInfo> buffer_infos;
+  std::vector<VulkanBuffer*> bound_buffers;
+  std::vector<BufferAccess> buffer_accesses;
+  // Descriptor sets are resolved lazily at dispatches, since a set depends on
+  // both the bound pipeline and the bound buffers
+  bool descriptors_dirty = true;
+
+  const auto record = [&](const auto& command) {
+    using T = std::decay_t<decltype(command)>;
+    if constexpr (std::is_same_v<T, BindPipelineCommand>) {
+      const auto* slot = compute_pipelines_pool_.try_get(command.pipeline);
+      if (slot == nullptr) {
+        beyond::panic("Vulkan backend binds an invalid pipeline handle");
+      }
+      BEYOND_ASSERT(slot->has_value());
+      pipeline = &**slot;
+      vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                        pipeline->pipeline());
+      descriptors_dirty = true;
+    } else if constexpr (std::is_same_v<T, BindBuffersCommand>) {
+      buffer_infos.clear();
+      bound_buffers.clear();
+      buffer_accesses.clear();
+      for (const auto& binding : command_list.bindings(command)) {
+        auto& buffer = get_buffer(binding.buffer);
+        buffer_infos.push_back(VkDescriptorBufferInfo{
+            .buffer = buffer.vkbuffer(),
+            .offset = 0,
+            .range = VK_WHOLE_SIZE,
+        });
+        bound_buffers.push_back(&buffer);
+        buffer_accesses.push_back(binding.access);
+      }
+      descriptors_dirty = true;
+    } else if constexpr (std::is_same_v<T, PushConstantsCommand>) {
+      BEYOND_ASSERT(pipeline != nullptr);
+      const auto data = command_list.data(command);
+      const auto size = static_cast<std::uint32_t>(data.size());
+      if (command.offset > pipeline->push_constant_size() ||
+          size > pipeline->push_constant_size() - command.offset) {
+        beyond::panic(
+            "Vulkan backend pushes constants out of the range of the pipeline");
+      }
+      vkCmdPushConstants(command_buffer, pipeline->pipeline_layout(),
+                         VK_SHADER_STAGE_COMPUTE_BIT, command.offset, size,
+                         data.data());
+    } else if constexpr (std::is_same_v<T, DispatchCommand>) {
+      BEYOND_ASSERT(pipeline != nullptr);
+      if (descriptors_dirty) {
+        if (buffer_infos.size() != pipeline->binding_count()) {
+          beyond::panic(fmt::format(
+              "Vulkan backend dispatches with {} bound buffers, but the "
+              "pipeline declares {}",
+              buffer_infos.size(), pipeline->binding_count()));
+        }
+        if (!buffer_infos.empty()) {
+          VkDescriptorSet descriptor_set = nullptr;
+          {
+            std::scoped_lock lock{descriptor_mutex_};
+            descriptor_set = descriptor_set_cache_.get(
+                pipeline->descriptor_set_layout(), buffer_infos);
+          }
+          vkCmdBindDescriptorSets(
+              command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+              pipeline->pipeline_layout(), 0, 1, &descriptor_set, 0, nullptr);
+        }
+        descriptors_dirty = false;
+      }
+      for (std::size_t i = 0; i < buffer_infos.size(); ++i) {
+        // The shader knows better than the list if it never writes a buffer
+        const auto access = pipeline->is_read_only(i)
+                                ? VK_ACCESS_SHADER_READ_BIT
+                                : to_shader_access(buffer_accesses[i]);
+        hazard_tracker.access(*bound_buffers[i],
+                              VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, access);
+      }
+      hazard_tracker.flush(command_buffer);
+      vkCmdDispatch(command_buffer, command.group_count[0],
+                    command.group_count[1], command.group_count[2]);
+    } else if constexpr (std::is_same_v<T, CopyBufferCommand>) {
+      auto& src = get_buffer(command.src);
+      auto& dst = get_buffer(command.dst);
+      std::vector<VkBufferCopy> copies;
+      for (const auto& region : command_list.regions(command)) {
+        if (!is_valid_copy_region(region, src.size(), dst.size(),
+                                  command.src.index() == command.dst.index())) {
+          beyond::panic("Vulkan backend copies an invalid buffer region");
+        }
+        copies.push_back(VkBufferCopy{.srcOffset = region.src_offset,
+                                      .dstOffset = region.dst_offset,
+                                      .size = region.size});
+      }
+      hazard_tracker.access(src, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                            VK_ACCESS_TRANSFER_READ_BIT);
+      hazard_tracker.access(dst, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                            VK_ACCESS_TRANSFER_WRITE_BIT);
+      hazard_tracker.flush(command_buffer);
+      vkCmdCopyBuffer(command_buffer, src.vkbuffer(), dst.vkbuffer(),
+                      to_u32(copies.size()), copies.data());
+    } else if constexpr (std::is_same_v<T, BarrierCommand>) {
+      barrier_between_commands(command_buffer);
+      hazard_tracker.reset();
+    }
   };
+  for (const auto& command : command_list.commands()) {
+    std::visit(record, command);
+  }
+}
 
-  const std::array write_descriptor_set = {
-      VkWriteDescriptorSet{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr,
-                           descriptor_set, 0, 0, 1,
-                           VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr,
-                           &in_descriptor_buffer_info, nullptr},
-      VkWriteDescriptorSet{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr,
-                           descriptor_set, 1, 0, 1,
-                           VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr,
-                           &out_descriptor_buffer_info, nullptr}};
-
-  vkUpdateDescriptorSets(device_, vulkan::to_u32(write_descriptor_set.size()),
-                         write_descriptor_set.data(), 0, nullptr);
-
-  const VkCommandPoolCreateInfo command_pool_create_info{
-      .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-      .pNext = nullptr,
-      .flags = 0,
-      .queueFamilyIndex = queue_family_indices_.compute_family};
-  VkCommandPool command_pool;
-  if (vkCreateCommandPool(device_, &command_pool_create_info, nullptr,
-                          &command_pool) != VK_SUCCESS) {
-    beyond::panic("Vulkan backend failed to create command pool");
+auto VulkanContext::upload_buffer(Buffer buffer_handle, std::size_t offset,
+                                  gsl::span<const std::byte> data)
+    -> SubmitToken
+{
+  collect_garbage();
+  std::shared_lock lock{resource_mutex_};
+
+  auto& dst_buffer = get_buffer(buffer_handle);
+  const auto dst = dst_buffer.vkbuffer();
+  const auto dst_size = dst_buffer.size();
+  auto remaining = static_cast<std::size_t>(data.size());
+  if (offset > dst_size || remaining > dst_size - offset) {
+    beyond::panic("Vulkan backend uploads out of the range of a buffer");
   }
 
-  const VkCommandBufferAllocateInfo command_buffer_allocate_info = {
-      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-      .pNext = nullptr,
-      .commandPool = command_pool,
-      .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-      .commandBufferCount = 1};
+  SubmitToken token{};
+  const auto* source = data.data();
+  auto dst_offset = static_cast<VkDeviceSize>(offset);
+  // Uploads larger than the staging ring are split into chunks, where each
+  // chunk is copied by its own submission
+  while (remaining != 0) {
+    const auto chunk_size = std::min(static_cast<VkDeviceSize>(remaining),
+                                     staging_ring_.capacity());
+
+    auto& frame = acquire_frame(QueueType::transfer);
+    auto& transfer_ring = queue_of(QueueType::transfer).command_ring;
+    staging_ring_.retire(transfer_ring.completed_value());
+
+    // Staging space is tagged with the timeline value of the transfer queue
+    // that the copy signals
+    const auto value = transfer_ring.submitted_value() + 1;
+    auto staging_offset = staging_ring_.allocate(chunk_size, value);
+    while (!staging_offset) {
+      transfer_ring.wait(*staging_ring_.oldest_serial());
+      staging_ring_.retire(transfer_ring.completed_value());
+      staging_offset = staging_ring_.allocate(chunk_size, value);
+    }
+
+    std::memcpy(staging_ring_.data(*staging_offset), source, chunk_size);
+    staging_ring_.flush(*staging_offset, chunk_size);
+
+    const auto command_buffer = frame.command_buffer;
+    begin_command_buffer(command_buffer);
 
-  VkCommandBuffer command_buffer;
-  if (vkAllocateCommandBuffers(device_, &command_buffer_allocate_info,
-                               &command_buffer) != VK_SUCCESS) {
-    beyond::panic("Vulkan backend failed to allocate command buffer");
+    barrier_before_transfer(command_buffer, transfer_queue_runs_compute());
+    const VkBufferCopy region{.srcOffset = *staging_offset,
+                              .dstOffset = dst_offset,
+                              .size = chunk_size};
+    vkCmdCopyBuffer(command_buffer, staging_ring_.vkbuffer(), dst, 1, &region);
+    barrier_after_transfer(command_buffer, transfer_queue_runs_compute());
+
+    token = submit_frame(QueueType::transfer, frame, std::array{&dst_buffer});
+
+    source += chunk_size;
+    dst_offset += chunk_size;
+    remaining -= static_cast<std::size_t>(chunk_size);
   }
 
-  const VkCommandBufferBeginInfo command_buffer_begin_info = {
-      .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-      .pNext = nullptr,
-      .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-      .pInheritanceInfo = nullptr};
+  return token;
+}
 
-  if (vkBeginCommandBuffer(command_buffer, &command_buffer_begin_info) !=
-      VK_SUCCESS) {
-    beyond::panic("Vulkan backend failed to begin command buffer");
+auto VulkanContext::copy_buffer(Buffer src_handle, Buffer dst_handle,
+                                gsl::span<const BufferCopyRegion> regions)
+    -> SubmitToken
+{
+  if (regions.empty()) {
+    return SubmitToken{};
   }
-  vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
-                    pipeline.pipeline());
-  vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
-                          pipeline.pipeline_layout(), 0, 1, &descriptor_set, 0,
-                          nullptr);
-  vkCmdDispatch(command_buffer,
-                static_cast<uint32_t>(buffer_size / sizeof(int32_t)), 1, 1);
-  if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
+
+  collect_garbage();
+  std::shared_lock lock{resource_mutex_};
+
+  auto& src = get_buffer(src_handle);
+  auto& dst = get_buffer(dst_handle);
+
+  std::vector<VkBufferCopy> copies;
+  copies.reserve(static_cast<std::size_t>(regions.size()));
+  for (const auto& region : regions) {
+    if (!is_valid_copy_region(region, src.size(), dst.size(),
+                              src_handle.index() == dst_handle.index())) {
+      beyond::panic("Vulkan backend copies an invalid buffer region");
+    }
+    copies.push_back(VkBufferCopy{.srcOffset = region.src_offset,
+                                  .dstOffset = region.dst_offset,
+                                  .size = region.size});
+  }
+
+  auto& frame = acquire_frame(QueueType::transfer);
+  const auto command_buffer = frame.command_buffer;
+
+  begin_command_buffer(command_buffer);
+  barrier_before_transfer(command_buffer, transfer_queue_runs_compute());
+  vkCmdCopyBuffer(command_buffer, src.vkbuffer(), dst.vkbuffer(),
+                  to_u32(copies.size()), copies.data());
+  barrier_after_transfer(command_buffer, transfer_queue_runs_compute());
+
+  return submit_frame(QueueType::transfer, frame, std::array{&src, &dst});
+}
+
+auto VulkanContext::acquire_frame(QueueType type) -> CommandRing::Frame&
+{
+  return queue_of(type).command_ring.acquire();
+}
+
+auto VulkanContext::submit_frame(QueueType type, CommandRing::Frame& frame,
+                                 gsl::span<VulkanBuffer* const> buffers)
+    -> SubmitToken
+{
+  if (vkEndCommandBuffer(frame.command_buffer) != VK_SUCCESS) {
     beyond::panic("Vulkan backend failed to end command buffer");
   }
 
-  VkSubmitInfo submit_info = {.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-                              .pNext = nullptr,
-                              .waitSemaphoreCount = 0,
-                              .pWaitSemaphores = nullptr,
-                              .pWaitDstStageMask = nullptr,
-                              .commandBufferCount = 1,
-                              .pCommandBuffers = &command_buffer,
-                              .signalSemaphoreCount = 0,
-                              .pSignalSemaphores = nullptr};
+  const auto slot = queue_slots_[static_cast<std::uint32_t>(type)];
+  auto& queue = queues_[slot];
+
+  // Both reads and writes of other queues must finish before the submission
+  // touches their buffers
+  Timepoint dependencies{};
+  for (auto* buffer : buffers) {
+    const auto& last_uses = buffer->last_uses();
+    for (std::uint32_t other_slot = 0; other_slot < queues_.size();
+         ++other_slot) {
+      dependencies[other_slot] =
+          std::max(dependencies[other_slot], last_uses[other_slot]);
+    }
+  }
+
+  // Waits for the submissions of other queues that the buffers depend on,
+  // unless an earlier submission of this queue already did. Semaphore
+  // operations are full memory dependencies, so buffers written by other
+  // queues need no extra barrier.
+  const VkPipelineStageFlags wait_stage =
+      type == QueueType::transfer ? VK_PIPELINE_STAGE_TRANSFER_BIT
+                                  : VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+                                        VK_PIPELINE_STAGE_TRANSFER_BIT;
+  std::array<VkSemaphore, queue_type_count> wait_semaphores{};
+  std::array<std::uint64_t, queue_type_count> wait_values{};
+  std::array<VkPipelineStageFlags, queue_type_count> wait_stages{};
+  std::uint32_t wait_count = 0;
+  for (std::uint32_t other_slot = 0; other_slot < queues_.size();
+       ++other_slot) {
+    auto& waited_value = queue.waited_values[other_slot];
+    if (other_slot == slot || dependencies[other_slot] <= waited_value) {
+      continue;
+    }
+
+    waited_value = dependencies[other_slot];
+    wait_semaphores[wait_count] = queues_[other_slot].command_ring.timeline();
+    wait_values[wait_count] = waited_value;
+    wait_stages[wait_count] = wait_stage;
+    ++wait_count;
+  }
 
-  const VkFenceCreateInfo fence_create_info{
-      .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+  const auto timeline = queue.command_ring.timeline();
+  const auto value = queue.command_ring.commit(frame);
+  for (auto* buffer : buffers) {
+    buffer->last_uses()[slot] = value;
+  }
+
+  const VkTimelineSemaphoreSubmitInfo timeline_info{
+      .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
       .pNext = nullptr,
-      .flags = 0,
+      .waitSemaphoreValueCount = wait_count,
+      .pWaitSemaphoreValues = wait_values.data(),
+      .signalSemaphoreValueCount = 1,
+      .pSignalSemaphoreValues = &value,
   };
-  VkFence fence;
-  vkCreateFence(device_, &fence_create_info, nullptr, &fence);
-  if (vkQueueSubmit(compute_queue_, 1, &submit_info, fence) != VK_SUCCESS) {
+  const VkSubmitInfo submit_info = {
+      .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+      .pNext = &timeline_info,
+      .waitSemaphoreCount = wait_count,
+      .pWaitSemaphores = wait_semaphores.data(),
+      .pWaitDstStageMask = wait_stages.data(),
+      .commandBufferCount = 1,
+      .pCommandBuffers = &frame.command_buffer,
+      .signalSemaphoreCount = 1,
+      .pSignalSemaphores = &timeline};
+
+  if (vkQueueSubmit(queue.queue, 1, &submit_info, nullptr) != VK_SUCCESS) {
     beyond::panic("Vulkan backend failed to submit to queue");
   }
 
-  static constexpr auto compute_timeout = static_cast<std::uint64_t>(1e6);
-  while (vkWaitForFences(device_, 1, &fence, VK_TRUE, compute_timeout) ==
-         VK_TIMEOUT) {
-    fmt::print("busy waiting\n");
+  return make_token(slot, value);
+}
+
+auto VulkanContext::queue_of(QueueType type) noexcept -> Queue&
+{
+  return queues_[queue_slots_[static_cast<std::uint32_t>(type)]];
+}
+
+auto VulkanContext::current_timepoint() const noexcept -> Timepoint
+{
+  Timepoint timepoint{};
+  for (std::uint32_t slot = 0; slot < queues_.size(); ++slot) {
+    timepoint[slot] = queues_[slot].command_ring.submitted_value();
   }
-  if (vkWaitForFences(device_, 1, &fence, VK_TRUE, 0) != VK_SUCCESS) {
-    beyond::panic("Vulkan backend failed to wait for fence");
+  return timepoint;
+}
+
+auto VulkanContext::is_reached(const Timepoint& timepoint) -> bool
+{
+  for (std::uint32_t slot = 0; slot < queues_.size(); ++slot) {
+    if (!queues_[slot].command_ring.is_reached(timepoint[slot])) {
+      return false;
+    }
   }
+  return true;
+}
 
-  vkDestroyFence(device_, fence, nullptr);
+auto VulkanContext::collect_garbage() -> void
+{
+  if (garbage_count_ == 0) {
+    return;
+  }
+  std::scoped_lock lock{resource_mutex_, descriptor_mutex_};
+
+  // Buffers can no longer be referred by new submissions, so the last
+  // submissions that used them are the last ones that may still do. Their
+  // descriptor sets are only used together with them.
+  for (auto& buffer : destroyed_buffers_) {
+    auto descriptor_sets = descriptor_set_cache_.evict(buffer.vkbuffer());
+    const auto last_uses = buffer.last_uses();
+    buffer_deletion_queue_.push(
+        last_uses,
+        RetiredBuffer{std::move(buffer), std::move(descriptor_sets)});
+  }
+  destroyed_buffers_.clear();
+  for (auto& pipeline : destroyed_pipelines_) {
+    pipeline_deletion_queue_.push(current_timepoint(), std::move(pipeline));
+  }
+  destroyed_pipelines_.clear();
+
+  buffer_deletion_queue_.collect(
+      [this](const Timepoint& timepoint) { return is_reached(timepoint); },
+      [this](RetiredBuffer&& retired) {
+        for (const auto& allocation : retired.descriptor_sets) {
+          descriptor_set_cache_.free(allocation);
+        }
+        --garbage_count_;
+      });
+  pipeline_deletion_queue_.collect(
+      [this](const Timepoint& timepoint) { return is_reached(timepoint); },
+      [this](VulkanPipeline&& pipeline) {
+        release_pipeline(std::move(pipeline));
+        --garbage_count_;
+      });
+}
 
-  vkDestroyCommandPool(device_, command_pool, nullptr);
-  vkDestroyDescriptorPool(device_, descriptor_pool, nullptr);
+auto VulkanContext::release_pipeline(VulkanPipeline&& pipeline) -> void
+{
+  const auto& shader = pipeline.shader_module();
+  const auto layout = pipeline.layout();
+  {
+    // Destroys the pipeline before the objects that it was created from
+    const auto retired = std::move(pipeline);
+  }
+
+  {
+    std::scoped_lock lock{shader_module_mutex_};
+    shader_module_cache_.release(shader);
+  }
+
+  bool set_layout_destroyed = false;
+  {
+    std::scoped_lock lock{layout_mutex_};
+    set_layout_destroyed = layout_cache_.release(layout);
+  }
+  // Cached sets are only used together with pipelines of their layout, so no
+  // submission in flight uses them anymore. A later layout may also reuse the
+  // handle, which must not find them.
+  if (set_layout_destroyed) {
+    for (const auto& allocation :
+         descriptor_set_cache_.evict_layout(layout.set_layout)) {
+      descriptor_set_cache_.free(allocation);
+    }
+  }
+}
+
+auto VulkanContext::transfer_queue_runs_compute() const noexcept -> bool
+{
+  return queue_slots_[static_cast<std::uint32_t>(QueueType::transfer)] ==
+         queue_slots_[static_cast<std::uint32_t>(QueueType::compute)];
+}
+
+auto VulkanContext::make_token(std::uint32_t slot,
+                               std::uint64_t value) noexcept -> SubmitToken
+{
+  return SubmitToken{(value << queue_slot_bits) | slot};
+}
+
+auto VulkanContext::resolve_token(SubmitToken token) noexcept
+    -> std::pair<CommandRing&, std::uint64_t>
+{
+  const auto slot = static_cast<std::uint32_t>(
+      token.get() & ((std::uint64_t{1} << queue_slot_bits) - 1));
+  BEYOND_ASSERT(slot < queues_.size());
+
+  return {queues_[slot].command_ring, token.get() >> queue_slot_bits};
+}
+
+[[nodiscard]] auto VulkanContext::is_complete(SubmitToken token) -> bool
+{
+  const auto resolved = resolve_token(token);
+  if (!resolved.first.is_reached(resolved.second)) {
+    return false;
+  }
+  // The finished submission may have been the last user of destroyed
+  // resources
+  collect_garbage();
+  return true;
+}
+
+auto VulkanContext::wait(SubmitToken token) -> void
+{
+  const auto resolved = resolve_token(token);
+  auto& ring = resolved.first;
+  const auto value = resolved.second;
+
+  wait_with_policy([&]() { return ring.is_reached(value); },
+                   [&]() { ring.wait(value); });
+  collect_garbage();
+}
+
+auto VulkanContext::wait_any(gsl::span<const SubmitToken> tokens) -> std::size_t
+{
+  const auto find_completed = [&]() {
+    return std::find_if(tokens.begin(), tokens.end(),
+                        [this](SubmitToken token) {
+                          const auto resolved = resolve_token(token);
+                          return resolved.first.is_reached(resolved.second);
+                        });
+  };
+
+  if (const auto completed = find_completed(); completed != tokens.end()) {
+    collect_garbage();
+    return static_cast<std::size_t>(completed - tokens.begin());
+  }
+  if (tokens.empty()) {
+    return 0;
+  }
+
+  std::vector<VkSemaphore> semaphores;
+  std::vector<std::uint64_t> values;
+  semaphores.reserve(static_cast<std::size_t>(tokens.size()));
+  values.reserve(static_cast<std::size_t>(tokens.size()));
+  for (const auto token : tokens) {
+    const auto resolved = resolve_token(token);
+    semaphores.push_back(resolved.first.timeline());
+    values.push_back(resolved.second);
+  }
+
+  wait_with_policy(
+      [&]() { return find_completed() != tokens.end(); },
+      [&]() {
+        const VkSemaphoreWaitInfo wait_info{
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .pNext = nullptr,
+            .flags = VK_SEMAPHORE_WAIT_ANY_BIT,
+            .semaphoreCount = to_u32(semaphores.size()),
+            .pSemaphores = semaphores.data(),
+            .pValues = values.data(),
+        };
+        if (vkWaitSemaphores(device_, &wait_info,
+                             std::numeric_limits<std::uint64_t>::max()) !=
+            VK_SUCCESS) {
+          beyond::panic("Vulkan backend failed to wait for timelines");
+        }
+      });
+
+  collect_garbage();
+  return static_cast<std::size_t>(find_completed() - tokens.begin());
 }
 
 } // namespace beyond::graphics::vulkan
@@ -476,26 +1372,46 @@ auto check_validation_layer_support() noexcept -> bool
       });
 }
 
-[[nodiscard]] auto create_instance(const beyond::Window& window) noexcept
+[[nodiscard]] auto loader_version() noexcept -> std::uint32_t
+{
+  // Vulkan 1.0 loaders do not provide `vkEnumerateInstanceVersion` and reject
+  // instances of newer versions
+  std::uint32_t instance_version = VK_API_VERSION_1_0;
+  if (vkEnumerateInstanceVersion != nullptr) {
+    vkEnumerateInstanceVersion(&instance_version);
+  }
+  return instance_version;
+}
+
+[[nodiscard]] auto create_instance(const beyond::Window* window) noexcept
     -> VkInstance
 {
   if (enable_validation_layers && !check_validation_layer_support()) {
     beyond::panic("validation layers requested, but not available!");
   }
 
+  if (loader_version() < VK_API_VERSION_1_2) {
+    beyond::panic("Vulkan backend requires a Vulkan 1.2 loader for timeline "
+                  "semaphores");
+  }
+
   VkInstance instance;
 
   const VkApplicationInfo app_info = {
       .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
       .pNext = nullptr,
-      .pApplicationName = window.title().c_str(),
+      .pApplicationName =
+          window != nullptr ? window->title().c_str() : "Beyond Headless",
       .applicationVersion = VK_MAKE_VERSION(1, 0, 0),
       .pEngineName = "Beyond Game Engine",
       .engineVersion = VK_MAKE_VERSION(1, 0, 0),
-      .apiVersion = VK_API_VERSION_1_0,
+      .apiVersion = VK_API_VERSION_1_2,
   };
 
-  auto extensions = window.get_required_instance_extensions();
+  std::vector<const char*> extensions;
+  if (window != nullptr) {
+    extensions = window->get_required_instance_extensions();
+  }
 #ifdef BEYOND_VULKAN_ENABLE_VALIDATION_LAYER
   extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 #endif
@@ -543,14 +1459,14 @@ auto check_validation_layer_support() noexcept -> bool
   scored_pairs.reserve(avaliable_devices.size());
   for (const auto& device : avaliable_devices) {
     const auto score = rate_physical_device(device, surface);
-    if (score > 0) {
+    if (score >= 0) {
       scored_pairs.emplace_back(score, device);
     }
   }
 
   if (scored_pairs.empty()) {
-    beyond::panic(
-        "Vulkan failed to find GPUs with enough nessesory graphics support!");
+    beyond::panic("Vulkan failed to find GPUs with enough nessesory graphics "
+                  "support, such as Vulkan 1.2 timeline semaphores!");
   }
 
   std::sort(std::begin(scored_pairs), std::end(scored_pairs),
@@ -569,9 +1485,50 @@ auto check_validation_layer_support() noexcept -> bool
   return physical_device;
 }
 
-[[nodiscard]] auto
-create_logical_device(VkPhysicalDevice pd,
-                      const QueueFamilyIndices& indices) noexcept -> VkDevice
+[[nodiscard]] auto supports_headless_context() noexcept -> bool
+{
+  if (volkInitialize() != VK_SUCCESS ||
+      loader_version() < VK_API_VERSION_1_2) {
+    return false;
+  }
+
+  // Layers and extensions do not change which devices are suitable, so a
+  // bare instance is enough
+  const VkApplicationInfo app_info = {
+      .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+      .pNext = nullptr,
+      .pApplicationName = "Beyond Headless",
+      .applicationVersion = VK_MAKE_VERSION(1, 0, 0),
+      .pEngineName = "Beyond Game Engine",
+      .engineVersion = VK_MAKE_VERSION(1, 0, 0),
+      .apiVersion = VK_API_VERSION_1_2,
+  };
+  VkInstanceCreateInfo create_info{};
+  create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+  create_info.pApplicationInfo = &app_info;
+
+  VkInstance instance;
+  if (vkCreateInstance(&create_info, nullptr, &instance) != VK_SUCCESS) {
+    return false;
+  }
+  volkLoadInstance(instance);
+
+  const auto devices = vulkan::get_vector_with<VkPhysicalDevice>(
+      [instance](uint32_t* count, VkPhysicalDevice* data) {
+        return vkEnumeratePhysicalDevices(instance, count, data);
+      });
+  const bool supported =
+      std::any_of(devices.begin(), devices.end(), [](VkPhysicalDevice device) {
+        return rate_physical_device(device, nullptr) >= 0;
+      });
+
+  vkDestroyInstance(instance, nullptr);
+  return supported;
+}
+
+[[nodiscard]] auto create_logical_device(VkPhysicalDevice pd,
+                                         const QueueFamilyIndices& indices,
+                                         bool headless) noexcept -> VkDevice
 {
   const auto unique_indices = indices.to_set();
 
@@ -592,10 +1549,14 @@ create_logical_device(VkPhysicalDevice pd,
                  });
 
   const VkPhysicalDeviceFeatures features = {};
+  VkPhysicalDeviceVulkan12Features vulkan12_features{};
+  vulkan12_features.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+  vulkan12_features.timelineSemaphore = VK_TRUE;
 
   const VkDeviceCreateInfo create_info{
       .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-      .pNext = nullptr,
+      .pNext = &vulkan12_features,
       .flags = 0,
       .queueCreateInfoCount = vulkan::to_u32(queue_create_infos.size()),
       .pQueueCreateInfos = queue_create_infos.data(),
@@ -606,8 +1567,9 @@ create_logical_device(VkPhysicalDevice pd,
       .enabledLayerCount = 0,
       .ppEnabledLayerNames = nullptr,
 #endif
-      .enabledExtensionCount = vulkan::to_u32(device_extensions.size()),
-      .ppEnabledExtensionNames = device_extensions.data(),
+      .enabledExtensionCount =
+          headless ? 0 : vulkan::to_u32(device_extensions.size()),
+      .ppEnabledExtensionNames = headless ? nullptr : device_extensions.data(),
       .pEnabledFeatures = &features,
   };
 
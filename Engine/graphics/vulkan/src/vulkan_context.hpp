@@ -14,33 +14,103 @@
 #include <beyond/utils/panic.hpp>
 
 #include <beyond/graphics/backend.hpp>
+#include <beyond/graphics/command_list.hpp>
+#include <beyond/graphics/slot_map.hpp>
 
 #include "vulkan_buffer.hpp"
+#include "vulkan_command_ring.hpp"
+#include "vulkan_deletion_queue.hpp"
+#include "vulkan_descriptor_allocator.hpp"
+#include "vulkan_hazard_tracker.hpp"
+#include "vulkan_layout_cache.hpp"
+#include "vulkan_mapped_file.hpp"
 #include "vulkan_pipeline.hpp"
+#include "vulkan_pipeline_cache.hpp"
+#include "vulkan_queue.hpp"
+#include "vulkan_shader_module.hpp"
+#include "vulkan_staging_ring.hpp"
 #include "vulkan_swapchain.hpp"
+#include "vulkan_worker_pool.hpp"
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <shared_mutex>
+#include <utility>
 #include <vector>
 
 namespace beyond::graphics::vulkan {
 
+/**
+ * @brief The Vulkan implementation of `Context`
+ *
+ * Creating, destroying and mapping resources are thread-safe, and may happen
+ * concurrently with submissions. Submitting and waiting must happen on one
+ * thread at a time.
+ *
+ * The context requires Vulkan 1.2 with timeline semaphores, and panics on older
+ * loaders or when no device supports them, which the headless factory checks
+ * beforehand to return `nullptr` instead. One timeline per queue orders the
+ * work of different queues by value, completes tokens by comparing counters,
+ * waits for several tokens at once with `vkWaitSemaphores`, and retires
+ * command buffers, staging space and destroyed resources without a fence per
+ * submission. A fence-based Vulkan 1.0 path would duplicate all of these,
+ * while the drivers of every desktop vendor and lavapipe provide Vulkan 1.2.
+ */
 class VulkanContext final : public Context {
 public:
-  explicit VulkanContext(Window& window);
+  /// @brief Creates a context that presents to `window`, or a headless
+  /// context if `window` is `nullptr`
+  explicit VulkanContext(Window* window);
   ~VulkanContext() noexcept override;
 
   [[nodiscard]] auto create_swapchain() -> Swapchain override;
   [[nodiscard]] auto create_buffer(const BufferCreateInfo& create_info)
       -> Buffer override;
   auto destory_buffer(Buffer& buffer_handle) -> void override;
+  auto flush_buffer(Buffer buffer_handle, std::size_t offset,
+                    std::size_t size) -> void override;
+  auto invalidate_buffer(Buffer buffer_handle, std::size_t offset,
+                         std::size_t size) -> void override;
 
   [[nodiscard]] auto
   create_compute_pipeline(const ComputePipelineCreateInfo& create_info)
       -> ComputePipeline override;
+  [[nodiscard]] auto create_compute_pipelines(
+      gsl::span<const ComputePipelineCreateInfo> create_infos)
+      -> std::vector<ComputePipeline> override;
+  [[nodiscard]] auto create_compute_pipelines_async(
+      gsl::span<const ComputePipelineCreateInfo> create_infos)
+      -> std::vector<ComputePipeline> override;
+  [[nodiscard]] auto is_pipeline_ready(ComputePipeline pipeline)
+      -> bool override;
+  [[nodiscard]] auto workgroup_size(ComputePipeline pipeline)
+      -> std::array<std::uint32_t, 3> override;
+  auto destroy_compute_pipeline(ComputePipeline pipeline_handle)
+      -> void override;
 
-  auto submit(gsl::span<SubmitInfo> infos) -> void override;
+  auto upload_buffer(Buffer buffer_handle, std::size_t offset,
+                     gsl::span<const std::byte> data) -> SubmitToken override;
+
+  auto copy_buffer(Buffer src_handle, Buffer dst_handle,
+                   gsl::span<const BufferCopyRegion> regions)
+      -> SubmitToken override;
+
+  auto set_recording_thread_count(std::uint32_t count) -> void override;
+  [[nodiscard]] auto is_complete(SubmitToken token) -> bool override;
+  auto wait(SubmitToken token) -> void override;
+  auto wait_any(gsl::span<const SubmitToken> tokens) -> std::size_t override;
+
+  [[nodiscard]] auto descriptor_cache_statistics() const noexcept
+      -> CacheStatistics override
+  {
+    std::scoped_lock lock{descriptor_mutex_};
+    return descriptor_set_cache_.statistics();
+  }
 
 private:
   VkInstance instance_ = nullptr;
@@ -52,22 +122,164 @@ private:
 #endif
 
   VkPhysicalDevice physical_device_ = nullptr;
+  // Queried once, since pipelines of a batch compile on several threads
+  std::uint32_t max_push_constant_size_ = 0;
   vulkan::QueueFamilyIndices queue_family_indices_{};
   VkDevice device_ = nullptr;
 
-  VkQueue graphics_queue_ = nullptr;
   VkQueue present_queue_ = nullptr;
-  VkQueue compute_queue_ = nullptr;
 
   VmaAllocator allocator_ = nullptr;
 
+  PipelineCache pipeline_cache_;
+
+  // Queues of distinct families, where `queue_slots_` maps every `QueueType`
+  // to one of them
+  std::vector<Queue> queues_;
+  std::array<std::uint32_t, queue_type_count> queue_slots_{};
+  std::vector<std::uint32_t> queue_families_;
+
+  DescriptorSetCache descriptor_set_cache_;
+  mutable std::mutex descriptor_mutex_; // Guards `descriptor_set_cache_`
+  LayoutCache layout_cache_;
+  std::mutex layout_mutex_; // Guards `layout_cache_`
+  ShaderModuleCache shader_module_cache_;
+  MappedFile default_shader_; // Only mapped if the shader is not embedded
+  // Guards `shader_module_cache_` and `default_shader_`
+  std::mutex shader_module_mutex_;
+  StagingRing staging_ring_;
+
+  // Translates command lists in parallel when there are multiple recording
+  // threads
+  std::unique_ptr<WorkerPool> recording_pool_;
+  // Compiles pipelines of batches, created on the first batch
+  std::unique_ptr<WorkerPool> compile_pool_;
+  std::mutex compile_pool_mutex_; // Guards the creation of `compile_pool_`
+
   beyond::StaticVector<VulkanSwapchain, 2> swapchains_pool_;
-  std::vector<VulkanBuffer> buffers_pool_;
-  std::vector<VulkanPipeline> compute_pipelines_pool_;
+  // Guards `buffers_`, `compute_pipelines_pool_`, `destroyed_buffers_` and
+  // `destroyed_pipelines_`. Recording holds a shared lock, while creation and
+  // destruction hold an exclusive lock.
+  std::shared_mutex resource_mutex_;
+  SlotMap<Buffer, VulkanBuffer> buffers_;
+  // Empty while the pipeline compiles asynchronously
+  SlotMap<ComputePipeline, std::optional<VulkanPipeline>>
+      compute_pipelines_pool_;
+  // Notified with `resource_mutex_` when an asynchronous pipeline is ready
+  std::condition_variable_any pipeline_ready_;
+  // Buffers destroyed since the last collection, which get tagged with a
+  // timepoint by `collect_garbage`
+  std::vector<VulkanBuffer> destroyed_buffers_;
+
+  // A destroyed buffer together with the descriptor sets that refer to it
+  struct RetiredBuffer {
+    VulkanBuffer buffer;
+    std::vector<DescriptorAllocation> descriptor_sets;
+  };
+  DeletionQueue<RetiredBuffer> buffer_deletion_queue_;
+  // Pipelines destroyed since the last collection, which retire like
+  // `destroyed_buffers_` and release their cached shader modules and layouts
+  // when they leave the deletion queue
+  std::vector<VulkanPipeline> destroyed_pipelines_;
+  DeletionQueue<VulkanPipeline> pipeline_deletion_queue_;
+  // The number of destroyed resources that are not freed yet, which lets
+  // collections without garbage skip the locks
+  std::atomic<std::size_t> garbage_count_ = 0;
 
   [[nodiscard]] auto map_memory_impl(Buffer buffer_handle) noexcept
       -> MappingInfo override;
   auto unmap_memory_impl(Buffer buffer_handle) noexcept -> void override;
+
+  auto submit_impl(gsl::span<const CommandList> command_lists)
+      -> SubmitToken override;
+
+  /// @brief Destroys a retired pipeline and releases its references to the
+  /// cached shader module and layouts, with `descriptor_mutex_` held
+  auto release_pipeline(VulkanPipeline&& pipeline) -> void;
+
+  /// @brief Compiles a compute pipeline without adding it to the context
+  [[nodiscard]] auto
+  compile_compute_pipeline(const ComputePipelineCreateInfo& create_info)
+      -> VulkanPipeline;
+
+  [[nodiscard]] auto compile_pool() -> WorkerPool&;
+
+  /// @brief Adds a pipeline to `compute_pipelines_pool_`, panics if the pool
+  /// runs out of handles
+  /// @note The caller must hold `resource_mutex_`
+  [[nodiscard]] auto add_pipeline(std::optional<VulkanPipeline> pipeline)
+      -> ComputePipeline;
+
+  /// @brief Checks if every pipeline that `command_lists` bind is compiled
+  /// @note The caller must hold `resource_mutex_`
+  [[nodiscard]] auto
+  are_pipelines_ready(gsl::span<const CommandList> command_lists) const
+      -> bool;
+
+  /// @brief Gets the buffers that `command_lists` access, without duplicates
+  /// @note The caller must hold `resource_mutex_`
+  [[nodiscard]] auto used_buffers(gsl::span<const CommandList> command_lists)
+      -> std::vector<VulkanBuffer*>;
+
+  /**
+   * @brief Records the commands of `command_list` into `command_buffer`,
+   * with the barriers that `hazard_tracker` finds between them
+   *
+   * Multiple threads may record into different command buffers concurrently
+   * while holding a shared lock of `resource_mutex_`.
+   */
+  auto record_commands(VkCommandBuffer command_buffer,
+                       const CommandList& command_list,
+                       HazardTracker& hazard_tracker) -> void;
+
+  // Tokens keep the slot of their queue in the lowest bits and the timeline
+  // value signaled by the submission in the rest
+  static constexpr std::uint64_t queue_slot_bits = 2;
+
+  /// @brief Acquires the next frame of the queue of `type` for recording
+  [[nodiscard]] auto acquire_frame(QueueType type) -> CommandRing::Frame&;
+
+  /**
+   * @brief Ends the command buffer of `frame` and submits it to the queue of
+   * `type`, after the work of other queues that uses `buffers`
+   * @return A token of the timeline value that the submission signals
+   * @note The caller must hold `resource_mutex_`
+   */
+  auto submit_frame(QueueType type, CommandRing::Frame& frame,
+                    gsl::span<VulkanBuffer* const> buffers) -> SubmitToken;
+
+  [[nodiscard]] auto queue_of(QueueType type) noexcept -> Queue&;
+
+  /// @brief Gets the timeline values of the latest submission of every queue
+  [[nodiscard]] auto current_timepoint() const noexcept -> Timepoint;
+
+  /// @brief Checks if every queue reached its value in `timepoint`
+  [[nodiscard]] auto is_reached(const Timepoint& timepoint) -> bool;
+
+  /**
+   * @brief Frees the destroyed resources that the GPU no longer uses
+   *
+   * Called before submissions, after waits and after destructions, without
+   * holding `resource_mutex_`. Any thread may collect.
+   */
+  auto collect_garbage() -> void;
+
+  /// @brief Returns `true` if transfers share the queue of dispatches
+  [[nodiscard]] auto transfer_queue_runs_compute() const noexcept -> bool;
+
+  [[nodiscard]] static auto make_token(std::uint32_t slot,
+                                       std::uint64_t value) noexcept
+      -> SubmitToken;
+
+  /// @brief Gets the command ring of the queue of `token`, and the timeline
+  /// value that the submission signals
+  [[nodiscard]] auto resolve_token(SubmitToken token) noexcept
+      -> std::pair<CommandRing&, std::uint64_t>;
+
+  /// @brief Gets the buffer refered by `buffer_handle`, panics if the handle is
+  /// invalid
+  /// @note The caller must hold `resource_mutex_`
+  [[nodiscard]] auto get_buffer(Buffer buffer_handle) -> VulkanBuffer&;
 };
 
 } // namespace beyond::graphics::vulkan
@@ -0,0 +1,65 @@
+#pragma once
+
+#ifndef BEYOND_GRAPHICS_VULKAN_DELETION_QUEUE_HPP
+#define BEYOND_GRAPHICS_VULKAN_DELETION_QUEUE_HPP
+
+#include "vulkan_queue.hpp"
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <utility>
+
+namespace beyond::graphics::vulkan {
+
+/**
+ * @brief Holds resources that are destroyed by the host but may still be in
+ * use by the GPU
+ *
+ * Each resource is tagged with the timepoint of the last submissions that may
+ * use it. Resources used by different queues retire in any order, so
+ * collecting checks every entry rather than stopping at the first one that is
+ * still in use.
+ */
+template <typename T> class DeletionQueue {
+public:
+  auto push(const Timepoint& timepoint, T resource) -> void
+  {
+    entries_.push_back(Entry{timepoint, std::move(resource)});
+  }
+
+  /**
+   * @brief Hands every resource whose timepoint is reached to `deleter`
+   * @param is_reached Returns whether the GPU reached a `Timepoint`
+   * @param deleter Consumes a resource by rvalue reference
+   */
+  template <typename IsReached, typename Deleter>
+  auto collect(IsReached&& is_reached, Deleter&& deleter) -> void
+  {
+    for (auto itr = entries_.begin(); itr != entries_.end();) {
+      if (is_reached(itr->timepoint)) {
+        deleter(std::move(itr->resource));
+        itr = entries_.erase(itr);
+      } else {
+        ++itr;
+      }
+    }
+  }
+
+  [[nodiscard]] auto size() const noexcept -> std::size_t
+  {
+    return entries_.size();
+  }
+
+private:
+  struct Entry {
+    Timepoint timepoint;
+    T resource;
+  };
+
+  std::deque<Entry> entries_;
+};
+
+} // namespace beyond::graphics::vulkan
+
+#endif // BEYOND_GRAPHICS_VULKAN_DELETION_QUEUE_HPP
@@ -0,0 +1,204 @@
+#include "vulkan_descriptor_allocator.hpp"
+#include "vulkan_utils.hpp"
+
+#include <beyond/utils/assert.hpp>
+#include <beyond/utils/panic.hpp>
+
+#include <algorithm>
+
+namespace beyond::graphics::vulkan {
+
+DescriptorAllocator::~DescriptorAllocator() noexcept
+{
+  destroy();
+}
+
+auto DescriptorAllocator::allocate(VkDescriptorSetLayout layout)
+    -> DescriptorAllocation
+{
+  // Newer pools are larger, so they are tried first
+  for (auto itr = pools_.rbegin(); itr != pools_.rend(); ++itr) {
+    if (itr->set_count == itr->capacity) {
+      continue;
+    }
+    if (const auto set = try_allocate(*itr, layout); set != nullptr) {
+      return {set, itr->pool};
+    }
+  }
+
+  auto& pool = grow();
+  const auto set = try_allocate(pool, layout);
+  if (set == nullptr) {
+    beyond::panic("Vulkan backend failed to allocate descriptor set");
+  }
+  return {set, pool.pool};
+}
+
+auto DescriptorAllocator::free(const DescriptorAllocation& allocation) noexcept
+    -> void
+{
+  const auto itr = std::find_if(
+      pools_.begin(), pools_.end(),
+      [&](const Pool& pool) { return pool.pool == allocation.pool; });
+  BEYOND_ASSERT(itr != pools_.end() && itr->set_count != 0);
+
+  // Resetting an empty pool also merges its fragmented free space
+  if (--itr->set_count == 0) {
+    vkResetDescriptorPool(device_, itr->pool, 0);
+  } else {
+    vkFreeDescriptorSets(device_, itr->pool, 1, &allocation.set);
+  }
+}
+
+auto DescriptorAllocator::try_allocate(Pool& pool,
+                                       VkDescriptorSetLayout layout)
+    -> VkDescriptorSet
+{
+  const VkDescriptorSetAllocateInfo allocate_info{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+      .pNext = nullptr,
+      .descriptorPool = pool.pool,
+      .descriptorSetCount = 1,
+      .pSetLayouts = &layout};
+
+  VkDescriptorSet set;
+  const auto result = vkAllocateDescriptorSets(device_, &allocate_info, &set);
+  if (result == VK_ERROR_OUT_OF_POOL_MEMORY ||
+      result == VK_ERROR_FRAGMENTED_POOL) {
+    return nullptr;
+  }
+  if (result != VK_SUCCESS) {
+    beyond::panic("Vulkan backend failed to allocate descriptor set");
+  }
+  ++pool.set_count;
+  return set;
+}
+
+auto DescriptorAllocator::grow() -> Pool&
+{
+  const auto capacity = next_pool_capacity_;
+  next_pool_capacity_ = std::min(next_pool_capacity_ * 2, max_pool_capacity);
+
+  const VkDescriptorPoolSize pool_size{.type =
+                                           VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                       .descriptorCount = capacity * 4};
+
+  const VkDescriptorPoolCreateInfo create_info = {
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
+      .maxSets = capacity,
+      .poolSizeCount = 1,
+      .pPoolSizes = &pool_size};
+
+  VkDescriptorPool pool;
+  if (vkCreateDescriptorPool(device_, &create_info, nullptr, &pool) !=
+      VK_SUCCESS) {
+    beyond::panic("Vulkan backend failed to create descriptor pool");
+  }
+  return pools_.emplace_back(
+      Pool{.pool = pool, .capacity = capacity, .set_count = 0});
+}
+
+auto DescriptorAllocator::destroy() noexcept -> void
+{
+  for (const auto& pool : pools_) {
+    vkDestroyDescriptorPool(device_, pool.pool, nullptr);
+  }
+  pools_.clear();
+}
+
+auto DescriptorSetCache::Key::operator==(const Key& other) const noexcept
+    -> bool
+{
+  return layout == other.layout &&
+         std::equal(buffers.begin(), buffers.end(), other.buffers.begin(),
+                    other.buffers.end(),
+                    [](const VkDescriptorBufferInfo& lhs,
+                       const VkDescriptorBufferInfo& rhs) {
+                      return lhs.buffer == rhs.buffer &&
+                             lhs.offset == rhs.offset &&
+                             lhs.range == rhs.range;
+                    });
+}
+
+auto DescriptorSetCache::KeyHash::operator()(const Key& key) const noexcept
+    -> std::size_t
+{
+  std::size_t seed = 0;
+  hash_combine(seed, key.layout);
+  for (const auto& buffer : key.buffers) {
+    hash_combine(seed, buffer.buffer);
+    hash_combine(seed, buffer.offset);
+    hash_combine(seed, buffer.range);
+  }
+  return seed;
+}
+
+auto DescriptorSetCache::get(VkDescriptorSetLayout layout,
+                             gsl::span<const VkDescriptorBufferInfo> buffers)
+    -> VkDescriptorSet
+{
+  scratch_key_.layout = layout;
+  scratch_key_.buffers.assign(buffers.begin(), buffers.end());
+
+  if (const auto itr = sets_.find(scratch_key_); itr != sets_.end()) {
+    ++statistics_.hits;
+    return itr->second.set;
+  }
+  ++statistics_.misses;
+
+  const auto allocation = allocator_.allocate(layout);
+
+  std::vector<VkWriteDescriptorSet> writes;
+  writes.reserve(static_cast<std::size_t>(buffers.size()));
+  for (std::uint32_t binding = 0; binding < buffers.size(); ++binding) {
+    writes.push_back(VkWriteDescriptorSet{
+        VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, allocation.set,
+        binding, 0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr,
+        &buffers[binding], nullptr});
+  }
+  vkUpdateDescriptorSets(device_, to_u32(writes.size()), writes.data(), 0,
+                         nullptr);
+
+  sets_.emplace(scratch_key_, allocation);
+  return allocation.set;
+}
+
+auto DescriptorSetCache::evict(VkBuffer buffer)
+    -> std::vector<DescriptorAllocation>
+{
+  std::vector<DescriptorAllocation> evicted;
+  for (auto itr = sets_.begin(); itr != sets_.end();) {
+    const auto& buffers = itr->first.buffers;
+    const bool refers_to_buffer =
+        std::any_of(buffers.begin(), buffers.end(),
+                    [buffer](const VkDescriptorBufferInfo& info) {
+                      return info.buffer == buffer;
+                    });
+    if (refers_to_buffer) {
+      evicted.push_back(itr->second);
+      itr = sets_.erase(itr);
+    } else {
+      ++itr;
+    }
+  }
+  return evicted;
+}
+
+auto DescriptorSetCache::evict_layout(VkDescriptorSetLayout layout)
+    -> std::vector<DescriptorAllocation>
+{
+  std::vector<DescriptorAllocation> evicted;
+  for (auto itr = sets_.begin(); itr != sets_.end();) {
+    if (itr->first.layout == layout) {
+      evicted.push_back(itr->second);
+      itr = sets_.erase(itr);
+    } else {
+      ++itr;
+    }
+  }
+  return evicted;
+}
+
+} // namespace beyond::graphics::vulkan
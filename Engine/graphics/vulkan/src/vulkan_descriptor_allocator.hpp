@@ -0,0 +1,154 @@
+#pragma once
+
+#ifndef BEYOND_GRAPHICS_VULKAN_DESCRIPTOR_ALLOCATOR_HPP
+#define BEYOND_GRAPHICS_VULKAN_DESCRIPTOR_ALLOCATOR_HPP
+
+#include <volk.h>
+
+#include <gsl/span>
+
+#include <beyond/graphics/backend.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace beyond::graphics::vulkan {
+
+struct DescriptorAllocation {
+  VkDescriptorSet set = nullptr;
+  VkDescriptorPool pool = nullptr;
+};
+
+/**
+ * @brief Allocates descriptor sets from a growing list of descriptor pools
+ *
+ * Allocations go to the pools that still have free sets, and a new pool with
+ * twice the capacity only gets created when none of them has enough space.
+ * Pools whose sets are all freed get reset to undo their fragmentation.
+ * Pools are only destoryed together with the allocator.
+ */
+class DescriptorAllocator {
+public:
+  DescriptorAllocator() = default;
+  explicit DescriptorAllocator(VkDevice device) : device_{device} {}
+  ~DescriptorAllocator() noexcept;
+
+  DescriptorAllocator(const DescriptorAllocator&) = delete;
+  auto operator=(const DescriptorAllocator&) & -> DescriptorAllocator& = delete;
+
+  DescriptorAllocator(DescriptorAllocator&& other) noexcept
+      : device_{std::exchange(other.device_, nullptr)},
+        pools_{std::move(other.pools_)}, next_pool_capacity_{std::exchange(
+                                             other.next_pool_capacity_,
+                                             initial_pool_capacity)}
+  {
+  }
+
+  auto operator=(DescriptorAllocator&& other) & noexcept
+      -> DescriptorAllocator&
+  {
+    destroy();
+    device_ = std::exchange(other.device_, nullptr);
+    pools_ = std::move(other.pools_);
+    next_pool_capacity_ =
+        std::exchange(other.next_pool_capacity_, initial_pool_capacity);
+    return *this;
+  }
+
+  [[nodiscard]] auto allocate(VkDescriptorSetLayout layout)
+      -> DescriptorAllocation;
+
+  auto free(const DescriptorAllocation& allocation) noexcept -> void;
+
+private:
+  static constexpr std::uint32_t initial_pool_capacity = 64;
+  static constexpr std::uint32_t max_pool_capacity = 4096;
+
+  struct Pool {
+    VkDescriptorPool pool = nullptr;
+    std::uint32_t capacity = 0;
+    std::uint32_t set_count = 0; // The number of sets not freed yet
+  };
+
+  VkDevice device_ = nullptr;
+  std::vector<Pool> pools_;
+  std::uint32_t next_pool_capacity_ = initial_pool_capacity;
+
+  /// @brief Allocates a set from `pool`, returns `nullptr` if the pool is out
+  /// of space
+  [[nodiscard]] auto try_allocate(Pool& pool, VkDescriptorSetLayout layout)
+      -> VkDescriptorSet;
+  auto grow() -> Pool&;
+  auto destroy() noexcept -> void;
+};
+
+/**
+ * @brief Caches descriptor sets of storage buffers
+ *
+ * Sets are keyed by the descriptor set layout and the buffer ranges bound to
+ * each binding, so repeated dispatches over the same buffers reuse the set
+ * written in the first dispatch. The i-th buffer range is bound to binding i.
+ */
+class DescriptorSetCache {
+public:
+  DescriptorSetCache() = default;
+  explicit DescriptorSetCache(VkDevice device)
+      : device_{device}, allocator_{device}
+  {
+  }
+
+  /// @brief Gets a descriptor set that refers to `buffers`
+  [[nodiscard]] auto get(VkDescriptorSetLayout layout,
+                         gsl::span<const VkDescriptorBufferInfo> buffers)
+      -> VkDescriptorSet;
+
+  /**
+   * @brief Removes all the cached sets that refer to `buffer`
+   *
+   * The sets may still be used by submissions in flight, so they are returned
+   * to the caller to be freed by `free` afterwards.
+   */
+  [[nodiscard]] auto evict(VkBuffer buffer)
+      -> std::vector<DescriptorAllocation>;
+
+  /// @brief Removes all the cached sets of `layout`, which get freed like the
+  /// ones returned by `evict`
+  [[nodiscard]] auto evict_layout(VkDescriptorSetLayout layout)
+      -> std::vector<DescriptorAllocation>;
+
+  /// @brief Frees a set that was evicted from the cache
+  auto free(const DescriptorAllocation& allocation) noexcept -> void
+  {
+    allocator_.free(allocation);
+  }
+
+  [[nodiscard]] auto statistics() const noexcept -> CacheStatistics
+  {
+    return statistics_;
+  }
+
+private:
+  struct Key {
+    VkDescriptorSetLayout layout = nullptr;
+    std::vector<VkDescriptorBufferInfo> buffers;
+
+    [[nodiscard]] auto operator==(const Key& other) const noexcept -> bool;
+  };
+
+  struct KeyHash {
+    [[nodiscard]] auto operator()(const Key& key) const noexcept
+        -> std::size_t;
+  };
+
+  VkDevice device_ = nullptr;
+  DescriptorAllocator allocator_;
+  std::unordered_map<Key, DescriptorAllocation, KeyHash> sets_;
+  Key scratch_key_; // Reused for lookups to avoid allocations
+  CacheStatistics statistics_;
+};
+
+} // namespace beyond::graphics::vulkan
+
+#endif // BEYOND_GRAPHICS_VULKAN_DESCRIPTOR_ALLOCATOR_HPP
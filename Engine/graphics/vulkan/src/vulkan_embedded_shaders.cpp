@@ -0,0 +1,26 @@
+#include "vulkan_embedded_shaders.hpp"
+
+#ifdef BEYOND_VULKAN_EMBED_SHADERS
+#include <beyond_embedded_shaders.hpp>
+#endif
+
+#include <cstddef>
+
+namespace beyond::graphics::vulkan {
+
+[[nodiscard]] auto find_embedded_shader(std::string_view name) noexcept
+    -> gsl::span<const std::uint32_t>
+{
+#ifdef BEYOND_VULKAN_EMBED_SHADERS
+  for (const auto& shader : embedded::shaders) {
+    if (name == shader.name) {
+      return {shader.code, static_cast<std::ptrdiff_t>(shader.size)};
+    }
+  }
+#else
+  (void)name;
+#endif
+  return {};
+}
+
+} // namespace beyond::graphics::vulkan
@@ -0,0 +1,26 @@
+#pragma once
+
+#ifndef BEYOND_GRAPHICS_VULKAN_EMBEDDED_SHADERS_HPP
+#define BEYOND_GRAPHICS_VULKAN_EMBEDDED_SHADERS_HPP
+
+#include <gsl/span>
+
+#include <cstdint>
+#include <string_view>
+
+namespace beyond::graphics::vulkan {
+
+/**
+ * @brief Finds the SPIR-V of a built-in shader that is compiled into the
+ * backend
+ * @param name The file name of the shader source, e.g. `copy.comp`
+ * @return The code of the shader, or an empty span if the shader is not
+ * embedded, which is always the case if the backend is built with
+ * `BEYOND_VULKAN_EMBED_SHADERS` off
+ */
+[[nodiscard]] auto find_embedded_shader(std::string_view name) noexcept
+    -> gsl::span<const std::uint32_t>;
+
+} // namespace beyond::graphics::vulkan
+
+#endif // BEYOND_GRAPHICS_VULKAN_EMBEDDED_SHADERS_HPP
@@ -0,0 +1,224 @@
+#include "vulkan_hazard_tracker.hpp"
+
+#include <beyond/utils/assert.hpp>
+
+#include "vulkan_utils.hpp"
+
+#include <algorithm>
+
+namespace beyond::graphics::vulkan {
+
+namespace {
+
+constexpr VkAccessFlags write_access_mask =
+    VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT |
+    VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+} // anonymous namespace
+
+auto HazardTracker::access(VulkanBuffer& buffer, VkPipelineStageFlags stage,
+                           VkAccessFlags access) -> void
+{
+  pending_accesses_.push_back({&buffer, stage, access});
+
+  // Hazards are checked against the state before this command, so that a
+  // command that binds a buffer several times does not depend on itself
+  const auto* state = find_state(buffer);
+  if (state == nullptr) {
+    // Deferred trackers order first accesses in `flush_entry` instead
+    if (deferred_) {
+      return;
+    }
+    state = &add_state(buffer);
+  }
+  add_hazards(buffer.vkbuffer(), state->accesses, stage, access);
+}
+
+auto HazardTracker::flush(VkCommandBuffer command_buffer) -> void
+{
+  emit_barrier(command_buffer);
+
+  // Merges the accesses of every buffer first, so that a read does not count
+  // as seeing a write of the same command
+  std::size_t merged_count = 0;
+  for (std::size_t i = 0; i < pending_accesses_.size(); ++i) {
+    const auto pending = pending_accesses_[i];
+    const auto merged_end =
+        pending_accesses_.begin() + static_cast<std::ptrdiff_t>(merged_count);
+    const auto itr = std::find_if(pending_accesses_.begin(), merged_end,
+                                  [&](const PendingAccess& merged) {
+                                    return merged.buffer == pending.buffer;
+                                  });
+    if (itr != merged_end) {
+      itr->stage |= pending.stage;
+      itr->access |= pending.access;
+    } else {
+      pending_accesses_[merged_count++] = pending;
+    }
+  }
+  pending_accesses_.resize(merged_count);
+
+  for (const auto& pending : pending_accesses_) {
+    auto* state = find_state(*pending.buffer);
+    if (state == nullptr) {
+      state = &add_state(*pending.buffer);
+    }
+
+    auto& accesses = state->accesses;
+    if (deferred_ && !fenced_ && accesses.write_stages == 0) {
+      state->entry_stages |= pending.stage;
+      state->entry_access |= pending.access;
+    }
+
+    const auto writes = pending.access & write_access_mask;
+    if (writes != 0) {
+      accesses = {.write_stages = pending.stage, .write_access = writes};
+    } else {
+      accesses.read_stages |= pending.stage;
+      accesses.read_access |= pending.access;
+    }
+  }
+  pending_accesses_.clear();
+}
+
+auto HazardTracker::reset() noexcept -> void
+{
+  for (auto& state : states_) {
+    state.accesses = {};
+  }
+  pending_accesses_.clear();
+  fenced_ = true;
+  src_stages_ = 0;
+  dst_stages_ = 0;
+  barriers_.clear();
+}
+
+auto HazardTracker::flush_entry(VkCommandBuffer command_buffer) -> void
+{
+  BEYOND_ASSERT(deferred_);
+  for (const auto& state : states_) {
+    if (state.entry_stages != 0) {
+      add_hazards(state.buffer->vkbuffer(), state.buffer->last_accesses(),
+                  state.entry_stages, state.entry_access);
+    }
+  }
+  emit_barrier(command_buffer);
+}
+
+auto HazardTracker::commit() noexcept -> void
+{
+  for (const auto& state : states_) {
+    auto& last = state.buffer->last_accesses();
+    // Reads of a deferred list that never writes the buffer are made visible
+    // to the last write by `flush_entry`, and join the reads before them
+    if (deferred_ && !fenced_ && state.accesses.write_stages == 0) {
+      last.read_stages |= state.accesses.read_stages;
+      last.read_access |= state.accesses.read_access;
+    } else {
+      last = state.accesses;
+    }
+  }
+}
+
+auto HazardTracker::find_state(const VulkanBuffer& buffer) noexcept
+    -> BufferState*
+{
+  const auto itr =
+      std::find_if(states_.begin(), states_.end(),
+                   [&buffer](const BufferState& state) {
+                     return state.buffer == &buffer;
+                   });
+  return itr != states_.end() ? &*itr : nullptr;
+}
+
+auto HazardTracker::add_state(VulkanBuffer& buffer) -> BufferState&
+{
+  // Deferred trackers learn the last accesses in `flush_entry`, and buffers
+  // first accessed after a full barrier are synchronized with everything
+  // before
+  return states_.emplace_back(BufferState{
+      .buffer = &buffer,
+      .accesses = deferred_ || fenced_ ? BufferAccesses{}
+                                       : buffer.last_accesses(),
+      .entry_stages = 0,
+      .entry_access = 0,
+  });
+}
+
+auto HazardTracker::add_hazards(VkBuffer buffer, const BufferAccesses& last,
+                                VkPipelineStageFlags stage,
+                                VkAccessFlags access) -> void
+{
+  const auto writes = access & write_access_mask;
+  const auto reads = access & ~write_access_mask;
+
+  VkPipelineStageFlags src_stages = 0;
+  VkAccessFlags src_access = 0;
+  if (last.write_stages != 0) {
+    // Read after write, unless an earlier read already made the write visible
+    // to this stage and access
+    const bool unseen_read =
+        reads != 0 && ((stage & ~last.read_stages) != 0 ||
+                       (reads & ~last.read_access) != 0);
+    // Write after write
+    if (writes != 0 || unseen_read) {
+      src_stages |= last.write_stages;
+      src_access |= last.write_access;
+    }
+  }
+  if (writes != 0 && last.read_stages != 0) {
+    // Write after read only needs an execution dependency
+    src_stages |= last.read_stages;
+  }
+
+  if (src_stages == 0) {
+    return;
+  }
+  src_stages_ |= src_stages;
+  dst_stages_ |= stage;
+  if (src_access != 0) {
+    add_barrier(buffer, src_access, access);
+  }
+}
+
+auto HazardTracker::add_barrier(VkBuffer buffer, VkAccessFlags src_access,
+                                VkAccessFlags dst_access) -> void
+{
+  // Merges the barriers of a buffer that is accessed several times by one
+  // command
+  const auto itr = std::find_if(barriers_.begin(), barriers_.end(),
+                                [buffer](const VkBufferMemoryBarrier& barrier) {
+                                  return barrier.buffer == buffer;
+                                });
+  if (itr != barriers_.end()) {
+    itr->srcAccessMask |= src_access;
+    itr->dstAccessMask |= dst_access;
+    return;
+  }
+
+  barriers_.push_back(VkBufferMemoryBarrier{
+      .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+      .pNext = nullptr,
+      .srcAccessMask = src_access,
+      .dstAccessMask = dst_access,
+      .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+      .buffer = buffer,
+      .offset = 0,
+      .size = VK_WHOLE_SIZE,
+  });
+}
+
+auto HazardTracker::emit_barrier(VkCommandBuffer command_buffer) -> void
+{
+  if (src_stages_ == 0) {
+    return;
+  }
+  vkCmdPipelineBarrier(command_buffer, src_stages_, dst_stages_, 0, 0, nullptr,
+                       to_u32(barriers_.size()), barriers_.data(), 0, nullptr);
+  src_stages_ = 0;
+  dst_stages_ = 0;
+  barriers_.clear();
+}
+
+} // namespace beyond::graphics::vulkan
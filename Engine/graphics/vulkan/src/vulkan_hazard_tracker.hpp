@@ -0,0 +1,103 @@
+#pragma once
+
+#ifndef BEYOND_GRAPHICS_VULKAN_HAZARD_TRACKER_HPP
+#define BEYOND_GRAPHICS_VULKAN_HAZARD_TRACKER_HPP
+
+#include <volk.h>
+
+#include "vulkan_buffer.hpp"
+
+#include <vector>
+
+namespace beyond::graphics::vulkan {
+
+/**
+ * @brief Tracks buffer accesses within a command list and inserts the
+ * barriers that they need
+ *
+ * Every command first declares its accesses with `access`, then calls `flush`
+ * to emit the barrier needed by these accesses before recording itself. All
+ * the hazards of one command are batched into a single `vkCmdPipelineBarrier`
+ * with one buffer memory barrier per buffer, and accesses without hazards,
+ * such as reads after reads, emit nothing.
+ *
+ * Hazards against earlier command lists of the queue come from the last
+ * accesses of every buffer, which `commit` updates once the list is recorded.
+ * A deferred tracker records a list whose place in the queue is unknown yet,
+ * such as a secondary command buffer recorded in parallel with the lists
+ * before it. It then collects the accesses that need to be ordered after the
+ * earlier lists, and `flush_entry` emits their barrier just before the list
+ * executes.
+ */
+class HazardTracker {
+public:
+  /// @brief Creates a tracker, which is deferred if `deferred` is `true`
+  explicit HazardTracker(bool deferred = false) noexcept : deferred_{deferred}
+  {
+  }
+
+  /// @brief Declares that the next command accesses `buffer`
+  auto access(VulkanBuffer& buffer, VkPipelineStageFlags stage,
+              VkAccessFlags access) -> void;
+
+  /// @brief Emits the barrier needed by the accesses declared since the last
+  /// flush, and makes them the latest accesses of their buffers
+  ///
+  /// All the accesses of a buffer by one command are merged, since they do not
+  /// see each other.
+  auto flush(VkCommandBuffer command_buffer) -> void;
+
+  /// @brief Forgets all the accesses, after a full barrier synchronized them
+  auto reset() noexcept -> void;
+
+  /// @brief Emits the barrier that orders the list of a deferred tracker
+  /// after the last accesses of its buffers
+  ///
+  /// Must be recorded right before the list executes, and before `commit`.
+  auto flush_entry(VkCommandBuffer command_buffer) -> void;
+
+  /// @brief Makes the accesses of the recorded list the last accesses of their
+  /// buffers
+  auto commit() noexcept -> void;
+
+private:
+  struct BufferState {
+    VulkanBuffer* buffer = nullptr;
+    BufferAccesses accesses;
+    // The accesses of a deferred tracker that are not ordered after earlier
+    // lists by the list itself, which are the ones up to the first write
+    VkPipelineStageFlags entry_stages = 0;
+    VkAccessFlags entry_access = 0;
+  };
+
+  struct PendingAccess {
+    VulkanBuffer* buffer = nullptr;
+    VkPipelineStageFlags stage = 0;
+    VkAccessFlags access = 0;
+  };
+
+  bool deferred_ = false;
+  // Whether a full barrier already synchronized the list with earlier ones
+  bool fenced_ = false;
+
+  // Command lists touch a handful of buffers, so linear searches beat hashing
+  std::vector<BufferState> states_;
+  std::vector<PendingAccess> pending_accesses_;
+
+  VkPipelineStageFlags src_stages_ = 0;
+  VkPipelineStageFlags dst_stages_ = 0;
+  std::vector<VkBufferMemoryBarrier> barriers_;
+
+  [[nodiscard]] auto find_state(const VulkanBuffer& buffer) noexcept
+      -> BufferState*;
+  auto add_state(VulkanBuffer& buffer) -> BufferState&;
+  auto add_hazards(VkBuffer buffer, const BufferAccesses& last,
+                   VkPipelineStageFlags stage, VkAccessFlags access) -> void;
+  auto add_barrier(VkBuffer buffer, VkAccessFlags src_access,
+                   VkAccessFlags dst_access) -> void;
+  auto emit_barrier(VkCommandBuffer command_buffer) -> void;
+};
+
+} // namespace beyond::graphics::vulkan
+
+#endif // BEYOND_GRAPHICS_VULKAN_HAZARD_TRACKER_HPP
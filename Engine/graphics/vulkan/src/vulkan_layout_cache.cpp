@@ -0,0 +1,168 @@
+#include "vulkan_layout_cache.hpp"
+#include "vulkan_utils.hpp"
+
+#include <beyond/utils/assert.hpp>
+#include <beyond/utils/panic.hpp>
+
+#include <algorithm>
+
+namespace beyond::graphics::vulkan {
+
+LayoutCache::~LayoutCache() noexcept
+{
+  destroy();
+}
+
+auto LayoutCache::SetLayoutKey::operator==(const SetLayoutKey& other) const
+    noexcept -> bool
+{
+  return std::equal(bindings.begin(), bindings.end(), other.bindings.begin(),
+                    other.bindings.end(),
+                    [](const VkDescriptorSetLayoutBinding& lhs,
+                       const VkDescriptorSetLayoutBinding& rhs) {
+                      return lhs.binding == rhs.binding &&
+                             lhs.descriptorType == rhs.descriptorType &&
+                             lhs.descriptorCount == rhs.descriptorCount &&
+                             lhs.stageFlags == rhs.stageFlags;
+                    });
+}
+
+auto LayoutCache::SetLayoutKeyHash::operator()(const SetLayoutKey& key) const
+    noexcept -> std::size_t
+{
+  std::size_t seed = 0;
+  for (const auto& binding : key.bindings) {
+    hash_combine(seed, binding.binding);
+    hash_combine(seed, binding.descriptorType);
+    hash_combine(seed, binding.descriptorCount);
+    hash_combine(seed, binding.stageFlags);
+  }
+  return seed;
+}
+
+auto LayoutCache::PipelineLayoutKeyHash::operator()(
+    const PipelineLayoutKey& key) const noexcept -> std::size_t
+{
+  std::size_t seed = 0;
+  hash_combine(seed, key.set_layout);
+  hash_combine(seed, key.push_constant_size);
+  return seed;
+}
+
+auto LayoutCache::get(gsl::span<const VkDescriptorSetLayoutBinding> bindings,
+                      std::uint32_t push_constant_size) -> PipelineLayout
+{
+  auto& set_layout = descriptor_set_layout(bindings);
+  return PipelineLayout{
+      .set_layout = set_layout.second.layout,
+      .pipeline_layout = pipeline_layout(set_layout, push_constant_size),
+      .push_constant_size = push_constant_size,
+  };
+}
+
+auto LayoutCache::release(const PipelineLayout& layout) noexcept -> bool
+{
+  const auto itr = pipeline_layouts_.find(
+      PipelineLayoutKey{layout.set_layout, layout.push_constant_size});
+  BEYOND_ASSERT(itr != pipeline_layouts_.end());
+  if (--itr->second.reference_count != 0) {
+    return false;
+  }
+  vkDestroyPipelineLayout(device_, itr->second.layout, nullptr);
+  const auto set_itr = set_layouts_.find(*itr->second.set_layout_key);
+  pipeline_layouts_.erase(itr);
+
+  BEYOND_ASSERT(set_itr != set_layouts_.end());
+  if (--set_itr->second.reference_count != 0) {
+    return false;
+  }
+  vkDestroyDescriptorSetLayout(device_, set_itr->second.layout, nullptr);
+  set_layouts_.erase(set_itr);
+  return true;
+}
+
+auto LayoutCache::descriptor_set_layout(
+    gsl::span<const VkDescriptorSetLayoutBinding> bindings)
+    -> SetLayoutMap::value_type&
+{
+  SetLayoutKey key{{bindings.begin(), bindings.end()}};
+  if (const auto itr = set_layouts_.find(key); itr != set_layouts_.end()) {
+    return *itr;
+  }
+
+  const VkDescriptorSetLayoutCreateInfo create_info{
+      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .bindingCount = to_u32(key.bindings.size()),
+      .pBindings = key.bindings.data()};
+
+  VkDescriptorSetLayout layout;
+  if (vkCreateDescriptorSetLayout(device_, &create_info, nullptr, &layout) !=
+      VK_SUCCESS) {
+    beyond::panic("Vulkan backend failed to create descriptor set layout");
+  }
+  return *set_layouts_
+              .emplace(std::move(key), CachedSetLayout{.layout = layout,
+                                                       .reference_count = 0})
+              .first;
+}
+
+auto LayoutCache::pipeline_layout(SetLayoutMap::value_type& set_layout,
+                                  std::uint32_t push_constant_size)
+    -> VkPipelineLayout
+{
+  const PipelineLayoutKey key{set_layout.second.layout, push_constant_size};
+  if (const auto itr = pipeline_layouts_.find(key);
+      itr != pipeline_layouts_.end()) {
+    ++itr->second.reference_count;
+    return itr->second.layout;
+  }
+
+  const VkPushConstantRange push_constant_range{
+      .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+      .offset = 0,
+      .size = push_constant_size,
+  };
+  const bool has_push_constants = push_constant_size != 0;
+
+  const VkPipelineLayoutCreateInfo create_info = {
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .setLayoutCount = 1,
+      .pSetLayouts = &set_layout.second.layout,
+      .pushConstantRangeCount = has_push_constants ? 1u : 0u,
+      .pPushConstantRanges =
+          has_push_constants ? &push_constant_range : nullptr};
+
+  VkPipelineLayout layout;
+  if (vkCreatePipelineLayout(device_, &create_info, nullptr, &layout) !=
+      VK_SUCCESS) {
+    beyond::panic("Vulkan backend failed to create pipeline layout");
+  }
+  pipeline_layouts_.emplace(
+      key, CachedPipelineLayout{.layout = layout,
+                                .set_layout_key = &set_layout.first,
+                                .reference_count = 1});
+  ++set_layout.second.reference_count;
+  return layout;
+}
+
+auto LayoutCache::destroy() noexcept -> void
+{
+  if (!device_) {
+    return;
+  }
+
+  for (const auto& [key, cached] : pipeline_layouts_) {
+    vkDestroyPipelineLayout(device_, cached.layout, nullptr);
+  }
+  for (const auto& [key, cached] : set_layouts_) {
+    vkDestroyDescriptorSetLayout(device_, cached.layout, nullptr);
+  }
+  pipeline_layouts_.clear();
+  set_layouts_.clear();
+}
+
+} // namespace beyond::graphics::vulkan
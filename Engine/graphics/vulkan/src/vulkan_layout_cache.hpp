@@ -0,0 +1,137 @@
+#pragma once
+
+#ifndef BEYOND_GRAPHICS_VULKAN_LAYOUT_CACHE_HPP
+#define BEYOND_GRAPHICS_VULKAN_LAYOUT_CACHE_HPP
+
+#include <volk.h>
+
+#include <gsl/span>
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace beyond::graphics::vulkan {
+
+/// @brief The layouts of a pipeline, which are owned by a `LayoutCache`
+struct PipelineLayout {
+  VkDescriptorSetLayout set_layout = nullptr;
+  VkPipelineLayout pipeline_layout = nullptr;
+  std::uint32_t push_constant_size = 0;
+};
+
+/**
+ * @brief Deduplicates descriptor set layouts and pipeline layouts
+ *
+ * Pipelines with the same interface share their layouts, which also makes
+ * their descriptor sets interchangeable. Every `get` takes a reference to the
+ * pipeline layout, which in turn references its descriptor set layout, and
+ * layouts are destroyed once all of their references are released.
+ */
+class LayoutCache {
+public:
+  LayoutCache() = default;
+  explicit LayoutCache(VkDevice device) : device_{device} {}
+  ~LayoutCache() noexcept;
+
+  LayoutCache(const LayoutCache&) = delete;
+  auto operator=(const LayoutCache&) & -> LayoutCache& = delete;
+
+  LayoutCache(LayoutCache&& other) noexcept
+      : device_{std::exchange(other.device_, nullptr)},
+        set_layouts_{std::move(other.set_layouts_)},
+        pipeline_layouts_{std::move(other.pipeline_layouts_)}
+  {
+  }
+
+  auto operator=(LayoutCache&& other) & noexcept -> LayoutCache&
+  {
+    destroy();
+    device_ = std::exchange(other.device_, nullptr);
+    set_layouts_ = std::move(other.set_layouts_);
+    pipeline_layouts_ = std::move(other.pipeline_layouts_);
+    return *this;
+  }
+
+  /**
+   * @brief Gets the layouts of a pipeline with a single descriptor set and a
+   * compute push constant range of `push_constant_size` bytes
+   *
+   * `bindings` must be sorted by their binding numbers.
+   */
+  [[nodiscard]] auto get(gsl::span<const VkDescriptorSetLayoutBinding> bindings,
+                         std::uint32_t push_constant_size) -> PipelineLayout;
+
+  /**
+   * @brief Releases a reference to `layout` taken by `get`, and destroys the
+   * layouts that are no longer referenced
+   * @return `true` if the descriptor set layout of `layout` got destroyed
+   */
+  auto release(const PipelineLayout& layout) noexcept -> bool;
+
+private:
+  struct SetLayoutKey {
+    std::vector<VkDescriptorSetLayoutBinding> bindings;
+
+    [[nodiscard]] auto operator==(const SetLayoutKey& other) const noexcept
+        -> bool;
+  };
+
+  struct SetLayoutKeyHash {
+    [[nodiscard]] auto operator()(const SetLayoutKey& key) const noexcept
+        -> std::size_t;
+  };
+
+  struct PipelineLayoutKey {
+    VkDescriptorSetLayout set_layout = nullptr;
+    std::uint32_t push_constant_size = 0;
+
+    [[nodiscard]] auto operator==(const PipelineLayoutKey& other) const noexcept
+        -> bool
+    {
+      return set_layout == other.set_layout &&
+             push_constant_size == other.push_constant_size;
+    }
+  };
+
+  struct PipelineLayoutKeyHash {
+    [[nodiscard]] auto operator()(const PipelineLayoutKey& key) const noexcept
+        -> std::size_t;
+  };
+
+  struct CachedSetLayout {
+    VkDescriptorSetLayout layout = nullptr;
+    // The number of pipeline layouts created from this layout
+    std::size_t reference_count = 0;
+  };
+
+  using SetLayoutMap =
+      std::unordered_map<SetLayoutKey, CachedSetLayout, SetLayoutKeyHash>;
+
+  struct CachedPipelineLayout {
+    VkPipelineLayout layout = nullptr;
+    // Elements of an unordered map never move, so this finds the set layout
+    // when the pipeline layout is destroyed
+    const SetLayoutKey* set_layout_key = nullptr;
+    std::size_t reference_count = 0;
+  };
+
+  VkDevice device_ = nullptr;
+  SetLayoutMap set_layouts_;
+  std::unordered_map<PipelineLayoutKey, CachedPipelineLayout,
+                     PipelineLayoutKeyHash>
+      pipeline_layouts_;
+
+  [[nodiscard]] auto
+  descriptor_set_layout(gsl::span<const VkDescriptorSetLayoutBinding> bindings)
+      -> SetLayoutMap::value_type&;
+  [[nodiscard]] auto pipeline_layout(SetLayoutMap::value_type& set_layout,
+                                     std::uint32_t push_constant_size)
+      -> VkPipelineLayout;
+  auto destroy() noexcept -> void;
+};
+
+} // namespace beyond::graphics::vulkan
+
+#endif // BEYOND_GRAPHICS_VULKAN_LAYOUT_CACHE_HPP
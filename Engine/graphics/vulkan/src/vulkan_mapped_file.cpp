@@ -0,0 +1,120 @@
+#include "vulkan_mapped_file.hpp"
+
+#include <beyond/utils/panic.hpp>
+
+#include <fmt/format.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace beyond::graphics::vulkan {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path)
+{
+  file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file_ == INVALID_HANDLE_VALUE) {
+    file_ = nullptr;
+    beyond::panic(fmt::format("failed to open file: {}\n", path));
+  }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file_, &size)) {
+    unmap();
+    beyond::panic(fmt::format("failed to open file: {}\n", path));
+  }
+  size_ = static_cast<std::size_t>(size.QuadPart);
+  if (size_ == 0) {
+    return; // Empty files cannot be mapped
+  }
+
+  mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping_ != nullptr) {
+    data_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+  }
+  if (data_ == nullptr) {
+    unmap();
+    beyond::panic(fmt::format("failed to map file: {}\n", path));
+  }
+}
+
+auto MappedFile::unmap() noexcept -> void
+{
+  if (data_ != nullptr) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_ != nullptr) {
+    CloseHandle(mapping_);
+  }
+  if (file_ != nullptr) {
+    CloseHandle(file_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  mapping_ = nullptr;
+  file_ = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+{
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    beyond::panic(fmt::format("failed to open file: {}\n", path));
+  }
+
+  struct stat status {
+  };
+  if (fstat(fd, &status) != 0) {
+    close(fd);
+    beyond::panic(fmt::format("failed to open file: {}\n", path));
+  }
+
+  // Empty files cannot be mapped
+  if (status.st_size > 0) {
+    const auto size = static_cast<std::size_t>(status.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      close(fd);
+      beyond::panic(fmt::format("failed to map file: {}\n", path));
+    }
+    data_ = data;
+    size_ = size;
+  }
+
+  // The mapping stays valid after closing the file
+  close(fd);
+}
+
+auto MappedFile::unmap() noexcept -> void
+{
+  if (data_ != nullptr) {
+    munmap(const_cast<void*>(data_), size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() noexcept
+{
+  unmap();
+}
+
+} // namespace beyond::graphics::vulkan
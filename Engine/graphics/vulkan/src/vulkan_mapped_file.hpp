@@ -0,0 +1,78 @@
+#pragma once
+
+#ifndef BEYOND_GRAPHICS_VULKAN_MAPPED_FILE_HPP
+#define BEYOND_GRAPHICS_VULKAN_MAPPED_FILE_HPP
+
+#include <gsl/span>
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+namespace beyond::graphics::vulkan {
+
+/**
+ * @brief A read-only view of a whole file through memory mapping
+ *
+ * The contents are paged in on demand without being copied, and the mapping
+ * is aligned to at least a page.
+ */
+class MappedFile {
+public:
+  MappedFile() = default;
+
+  /// @brief Maps the file at `path`, panics if it cannot be opened
+  explicit MappedFile(const std::string& path);
+  ~MappedFile() noexcept;
+
+  MappedFile(const MappedFile&) = delete;
+  auto operator=(const MappedFile&) & -> MappedFile& = delete;
+
+  MappedFile(MappedFile&& other) noexcept
+      : data_{std::exchange(other.data_, nullptr)}, size_{std::exchange(
+                                                        other.size_, 0)}
+#ifdef _WIN32
+        ,
+        file_{std::exchange(other.file_, nullptr)},
+        mapping_{std::exchange(other.mapping_, nullptr)}
+#endif
+  {
+  }
+
+  auto operator=(MappedFile&& other) & noexcept -> MappedFile&
+  {
+    unmap();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+#ifdef _WIN32
+    file_ = std::exchange(other.file_, nullptr);
+    mapping_ = std::exchange(other.mapping_, nullptr);
+#endif
+    return *this;
+  }
+
+  [[nodiscard]] auto bytes() const noexcept -> gsl::span<const std::byte>
+  {
+    return {static_cast<const std::byte*>(data_),
+            static_cast<std::ptrdiff_t>(size_)};
+  }
+
+  [[nodiscard]] auto size() const noexcept -> std::size_t
+  {
+    return size_;
+  }
+
+private:
+  const void* data_ = nullptr;
+  std::size_t size_ = 0;
+#ifdef _WIN32
+  void* file_ = nullptr;
+  void* mapping_ = nullptr;
+#endif
+
+  auto unmap() noexcept -> void;
+};
+
+} // namespace beyond::graphics::vulkan
+
+#endif // BEYOND_GRAPHICS_VULKAN_MAPPED_FILE_HPP
@@ -1,87 +1,143 @@
 #include <beyond/utils/panic.hpp>
 
+#include <algorithm>
 #include <array>
+#include <vector>
 
 #include "vulkan_pipeline.hpp"
-#include "vulkan_shader_module.hpp"
 #include "vulkan_utils.hpp"
 
 namespace beyond::graphics::vulkan {
 
-auto VulkanPipeline::create_compute(ComputePipelineCreateInfo /*info*/,
-                                    VkDevice device) -> VulkanPipeline
+namespace {
+
+// Resolves the local size of a shader, where the specializable dimensions
+// take their specialization constants
+[[nodiscard]] auto resolve_workgroup_size(const ComputePipelineCreateInfo& info,
+                                          const ShaderReflection& reflection)
+    -> std::array<std::uint32_t, 3>
 {
-  const auto shader_module =
-      create_shader_module("shaders/copy.comp.spv", device);
+  auto workgroup_size = reflection.local_size;
+  for (std::size_t i = 0; i < workgroup_size.size(); ++i) {
+    const auto spec_id = reflection.local_size_spec_ids[i];
+    if (spec_id < info.workgroup_size.size()) {
+      workgroup_size[i] = info.workgroup_size[spec_id];
+      continue;
+    }
+
+    const auto& constants = info.specialization_constants;
+    const auto constant = std::find_if(
+        constants.begin(), constants.end(),
+        [spec_id](const SpecializationConstant& c) { return c.id == spec_id; });
+    if (constant != constants.end()) {
+      workgroup_size[i] = constant->value;
+    }
+  }
+  return workgroup_size;
+}
 
-  std::array descriptor_set_layout_bindings{
-      VkDescriptorSetLayoutBinding{0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1,
-                                   VK_SHADER_STAGE_COMPUTE_BIT, nullptr},
-      VkDescriptorSetLayoutBinding{1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1,
-                                   VK_SHADER_STAGE_COMPUTE_BIT, nullptr}};
+} // anonymous namespace
 
-  const VkDescriptorSetLayoutCreateInfo descriptor_set_layout_create_info{
-      .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-      .pNext = nullptr,
-      .flags = 0,
-      .bindingCount = vulkan::to_u32(descriptor_set_layout_bindings.size()),
-      .pBindings = descriptor_set_layout_bindings.data()};
-
-  VkDescriptorSetLayout descriptor_set_layout;
-  if (vkCreateDescriptorSetLayout(device, &descriptor_set_layout_create_info,
-                                  nullptr,
-                                  &descriptor_set_layout) != VK_SUCCESS) {
-    beyond::panic("Vulkan backend failed to create descriptor set layout");
+auto VulkanPipeline::create_compute(const ComputePipelineCreateInfo& info,
+                                    const ShaderModule& shader,
+                                    const PipelineLayout& layout,
+                                    VkDevice device,
+                                    VkPipelineCache pipeline_cache)
+    -> VulkanPipeline
+{
+  if (std::find(info.workgroup_size.begin(), info.workgroup_size.end(), 0u) !=
+      info.workgroup_size.end()) {
+    beyond::panic("Vulkan backend requires a non-zero workgroup size");
   }
 
-  const VkPipelineLayoutCreateInfo pipeline_layout_create_info = {
-      .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-      .pNext = nullptr,
-      .flags = 0,
-      .setLayoutCount = 1,
-      .pSetLayouts = &descriptor_set_layout,
-      .pushConstantRangeCount = 0,
-      .pPushConstantRanges = nullptr};
-
-  VkPipelineLayout pipeline_layout;
-  if (vkCreatePipelineLayout(device, &pipeline_layout_create_info, nullptr,
-                             &pipeline_layout) != VK_SUCCESS) {
-    beyond::panic("Vulkan backend failed to create pipeline layout");
+  std::vector<VkSpecializationMapEntry> map_entries;
+  std::vector<std::uint32_t> specialization_data;
+  const auto add_constant = [&](std::uint32_t id, std::uint32_t value) {
+    map_entries.push_back(VkSpecializationMapEntry{
+        .constantID = id,
+        .offset = to_u32(specialization_data.size() * sizeof(std::uint32_t)),
+        .size = sizeof(std::uint32_t)});
+    specialization_data.push_back(value);
+  };
+
+  // The workgroup size occupies the constants 0, 1 and 2
+  const auto dimensions = to_u32(info.workgroup_size.size());
+  for (std::uint32_t i = 0; i < dimensions; ++i) {
+    add_constant(i, info.workgroup_size[i]);
+  }
+  for (const auto& constant : info.specialization_constants) {
+    if (constant.id < dimensions) {
+      beyond::panic("Specialization constants 0 to 2 are reserved for the "
+                    "workgroup size");
+    }
+    add_constant(constant.id, constant.value);
   }
 
+  const VkSpecializationInfo specialization_info{
+      .mapEntryCount = to_u32(map_entries.size()),
+      .pMapEntries = map_entries.data(),
+      .dataSize = specialization_data.size() * sizeof(std::uint32_t),
+      .pData = specialization_data.data(),
+  };
+
   const VkComputePipelineCreateInfo compute_pipeline_create_info{
       .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
       .pNext = nullptr,
       .flags = 0,
       .stage = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0,
-                VK_SHADER_STAGE_COMPUTE_BIT, shader_module, "main", nullptr},
-      .layout = pipeline_layout,
+                VK_SHADER_STAGE_COMPUTE_BIT, shader.module, "main",
+                &specialization_info},
+      .layout = layout.pipeline_layout,
       .basePipelineHandle = nullptr,
       .basePipelineIndex = 0,
   };
 
   VkPipeline pipeline;
-  if (vkCreateComputePipelines(device, nullptr, 1,
+  if (vkCreateComputePipelines(device, pipeline_cache, 1,
                                &compute_pipeline_create_info, nullptr,
                                &pipeline) != VK_SUCCESS) {
     beyond::panic("Vulkan backend failed to create compute pipeline");
   }
 
-  vkDestroyShaderModule(device, shader_module, nullptr);
+  const auto& reflection = shader.reflection;
+  std::vector<bool> read_only_bindings;
+  for (const auto& binding : reflection.bindings) {
+    read_only_bindings.push_back(binding.read_only);
+  }
+  return VulkanPipeline{device, shader, layout, pipeline,
+                        resolve_workgroup_size(info, reflection),
+                        std::move(read_only_bindings)};
+}
 
-  return VulkanPipeline{device, descriptor_set_layout, pipeline_layout,
-                        pipeline};
+auto VulkanPipeline::layout_bindings(const ShaderReflection& reflection)
+    -> std::vector<VkDescriptorSetLayoutBinding>
+{
+  std::vector<VkDescriptorSetLayoutBinding> bindings;
+  for (const auto& binding : reflection.bindings) {
+    if (binding.set != 0 || binding.binding != bindings.size()) {
+      beyond::panic("Vulkan backend requires shader bindings to be "
+                    "consecutive from binding 0 of set 0");
+    }
+    if (binding.type != VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ||
+        binding.count != 1) {
+      beyond::panic("Vulkan backend only supports shaders that bind single "
+                    "storage buffers");
+    }
+    bindings.push_back(VkDescriptorSetLayoutBinding{
+        .binding = binding.binding,
+        .descriptorType = binding.type,
+        .descriptorCount = binding.count,
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .pImmutableSamplers = nullptr});
+  }
+  return bindings;
 }
 
 VulkanPipeline::~VulkanPipeline() noexcept
 {
   if (device_) {
     vkDestroyPipeline(device_, pipeline_, nullptr);
-    vkDestroyPipelineLayout(device_, pipeline_layout_, nullptr);
-    vkDestroyDescriptorSetLayout(device_, descriptor_set_layout_, nullptr);
   }
-
-  // vkDestroyShaderModule(device_, shader_module, nullptr);
 }
 
 } // namespace beyond::graphics::vulkan
@@ -3,17 +3,43 @@
 #ifndef BEYOND_GRAPHICS_VULKAN_PIPELINE_HPP
 #define BEYOND_GRAPHICS_VULKAN_PIPELINE_HPP
 
+#include <array>
+#include <cstdint>
 #include <utility>
+#include <vector>
 #include <volk.h>
 
 #include <beyond/graphics/backend.hpp>
 
+#include "vulkan_layout_cache.hpp"
+#include "vulkan_shader_module.hpp"
+#include "vulkan_shader_reflection.hpp"
+
 namespace beyond::graphics::vulkan {
 
 class VulkanPipeline {
 public:
-  static auto create_compute(ComputePipelineCreateInfo info, VkDevice device)
-      -> VulkanPipeline;
+  /**
+   * @brief Creates a compute pipeline from a cached shader module
+   *
+   * `layout` must be created from `layout_bindings(shader.reflection)`. The
+   * pipeline holds on to the references to `shader` and `layout`, which the
+   * context releases when it destroys the pipeline.
+   */
+  static auto create_compute(const ComputePipelineCreateInfo& info,
+                             const ShaderModule& shader,
+                             const PipelineLayout& layout, VkDevice device,
+                             VkPipelineCache pipeline_cache) -> VulkanPipeline;
+
+  /**
+   * @brief Gets the descriptor set layout bindings of a shader
+   *
+   * Panics unless the shader only declares single storage buffers at
+   * consecutive bindings of descriptor set `0`, which is what
+   * `CommandList::bind_buffers` supplies.
+   */
+  [[nodiscard]] static auto layout_bindings(const ShaderReflection& reflection)
+      -> std::vector<VkDescriptorSetLayoutBinding>;
 
   ~VulkanPipeline() noexcept;
   VulkanPipeline(const VulkanPipeline&) = delete;
@@ -21,30 +47,41 @@ public:
 
   VulkanPipeline(VulkanPipeline&& other) noexcept
       : device_{std::exchange(other.device_, nullptr)},
-        descriptor_set_layout_{
-            std::exchange(other.descriptor_set_layout_, nullptr)},
-        pipeline_layout_{std::exchange(other.pipeline_layout_, nullptr)},
-        pipeline_{std::exchange(other.pipeline_, nullptr)}
+        shader_{std::exchange(other.shader_, nullptr)}, layout_{other.layout_},
+        pipeline_{std::exchange(other.pipeline_, nullptr)},
+        workgroup_size_{other.workgroup_size_},
+        read_only_bindings_{std::move(other.read_only_bindings_)}
   {
   }
 
   auto operator=(VulkanPipeline&& other) & noexcept
   {
     device_ = std::exchange(other.device_, nullptr);
-    descriptor_set_layout_ =
-        std::exchange(other.descriptor_set_layout_, nullptr);
-    pipeline_layout_ = std::exchange(other.pipeline_layout_, nullptr);
+    shader_ = std::exchange(other.shader_, nullptr);
+    layout_ = other.layout_;
     pipeline_ = std::exchange(other.pipeline_, nullptr);
+    workgroup_size_ = other.workgroup_size_;
+    read_only_bindings_ = std::move(other.read_only_bindings_);
+  }
+
+  [[nodiscard]] auto shader_module() const noexcept -> const ShaderModule&
+  {
+    return *shader_;
+  }
+
+  [[nodiscard]] auto layout() const noexcept -> const PipelineLayout&
+  {
+    return layout_;
   }
 
   [[nodiscard]] auto descriptor_set_layout() const noexcept
   {
-    return descriptor_set_layout_;
+    return layout_.set_layout;
   }
 
   [[nodiscard]] auto pipeline_layout() const noexcept
   {
-    return pipeline_layout_;
+    return layout_.pipeline_layout;
   }
 
   [[nodiscard]] auto pipeline() const noexcept
@@ -52,19 +89,50 @@ public:
     return pipeline_;
   }
 
+  /// @brief Gets the local workgroup size that the pipeline is specialized with
+  [[nodiscard]] auto workgroup_size() const noexcept
+      -> const std::array<std::uint32_t, 3>&
+  {
+    return workgroup_size_;
+  }
+
+  /// @brief Gets the size in bytes of the push constant range of the compute
+  /// stage
+  [[nodiscard]] auto push_constant_size() const noexcept -> std::uint32_t
+  {
+    return layout_.push_constant_size;
+  }
+
+  /// @brief Gets the number of storage buffers that dispatches must bind
+  [[nodiscard]] auto binding_count() const noexcept -> std::size_t
+  {
+    return read_only_bindings_.size();
+  }
+
+  /// @brief Returns `true` if the shader never writes the buffer at `binding`
+  [[nodiscard]] auto is_read_only(std::size_t binding) const noexcept -> bool
+  {
+    return read_only_bindings_[binding];
+  }
+
 private:
-  explicit VulkanPipeline(VkDevice device,
-                          VkDescriptorSetLayout descriptor_set_layout,
-                          VkPipelineLayout pipeline_layout, VkPipeline pipeline)
-      : device_{device}, descriptor_set_layout_{descriptor_set_layout},
-        pipeline_layout_{pipeline_layout}, pipeline_{pipeline}
+  explicit VulkanPipeline(VkDevice device, const ShaderModule& shader,
+                          const PipelineLayout& layout, VkPipeline pipeline,
+                          const std::array<std::uint32_t, 3>& workgroup_size,
+                          std::vector<bool> read_only_bindings)
+      : device_{device}, shader_{&shader}, layout_{layout},
+        pipeline_{pipeline}, workgroup_size_{workgroup_size},
+        read_only_bindings_{std::move(read_only_bindings)}
   {
   }
 
   VkDevice device_ = nullptr;
-  VkDescriptorSetLayout descriptor_set_layout_ = nullptr;
-  VkPipelineLayout pipeline_layout_ = nullptr;
+  // Both owned by the caches of the context
+  const ShaderModule* shader_ = nullptr;
+  PipelineLayout layout_;
   VkPipeline pipeline_ = nullptr;
+  std::array<std::uint32_t, 3> workgroup_size_{};
+  std::vector<bool> read_only_bindings_;
 };
 
 } // namespace beyond::graphics::vulkan
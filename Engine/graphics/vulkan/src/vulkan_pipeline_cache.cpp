@@ -0,0 +1,201 @@
+#include "vulkan_pipeline_cache.hpp"
+
+#include <beyond/utils/panic.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+constexpr std::uint32_t file_magic = 0x43505942; // "BYPC"
+constexpr std::uint32_t file_version = 1;
+
+// The prefix of a pipeline cache file. Unlike the header written by the
+// driver, it also records the driver version, since drivers may reject or
+// even crash on data from another version with the same UUID.
+struct FileHeader {
+  std::uint32_t magic = file_magic;
+  std::uint32_t version = file_version;
+  std::uint32_t vendor_id = 0;
+  std::uint32_t device_id = 0;
+  std::uint32_t driver_version = 0;
+  std::uint32_t reserved = 0; // Keeps the struct free of padding
+  std::array<std::uint8_t, VK_UUID_SIZE> pipeline_cache_uuid{};
+  std::uint64_t data_size = 0;
+};
+
+[[nodiscard]] auto
+make_file_header(const VkPhysicalDeviceProperties& properties,
+                 std::uint64_t data_size) noexcept -> FileHeader
+{
+  FileHeader header{};
+  header.vendor_id = properties.vendorID;
+  header.device_id = properties.deviceID;
+  header.driver_version = properties.driverVersion;
+  std::copy(std::begin(properties.pipelineCacheUUID),
+            std::end(properties.pipelineCacheUUID),
+            header.pipeline_cache_uuid.begin());
+  header.data_size = data_size;
+  return header;
+}
+
+// Checks the header that the driver puts in front of the data returned by
+// `vkGetPipelineCacheData`
+[[nodiscard]] auto
+is_compatible_cache_data(const std::vector<char>& data,
+                         const VkPhysicalDeviceProperties& properties) noexcept
+    -> bool
+{
+  struct {
+    std::uint32_t header_size;
+    std::uint32_t header_version;
+    std::uint32_t vendor_id;
+    std::uint32_t device_id;
+    std::array<std::uint8_t, VK_UUID_SIZE> pipeline_cache_uuid;
+  } header{};
+  static_assert(sizeof(header) == 16 + VK_UUID_SIZE);
+
+  if (data.size() < sizeof(header)) {
+    return false;
+  }
+  std::memcpy(&header, data.data(), sizeof(header));
+
+  return header.header_size >= sizeof(header) &&
+         header.header_version == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         header.vendor_id == properties.vendorID &&
+         header.device_id == properties.deviceID &&
+         std::equal(header.pipeline_cache_uuid.begin(),
+                    header.pipeline_cache_uuid.end(),
+                    std::begin(properties.pipelineCacheUUID));
+}
+
+// Returns an empty vector if the file does not exist or is not compatible
+// with the physical device
+[[nodiscard]] auto read_cache_file(const std::string& path,
+                                   const VkPhysicalDeviceProperties& properties)
+    -> std::vector<char>
+{
+  std::ifstream file(path, std::ios::ate | std::ios::binary);
+  if (!file.is_open()) {
+    return {};
+  }
+
+  const auto file_size = static_cast<std::size_t>(file.tellg());
+  if (file_size < sizeof(FileHeader)) {
+    return {};
+  }
+
+  FileHeader header;
+  file.seekg(0);
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+  const auto expected = make_file_header(properties, header.data_size);
+  if (std::memcmp(&header, &expected, sizeof(header)) != 0 ||
+      header.data_size != file_size - sizeof(FileHeader)) {
+    std::fputs("Vulkan backend discards an incompatible pipeline cache\n",
+               stderr);
+    return {};
+  }
+
+  std::vector<char> data(static_cast<std::size_t>(header.data_size));
+  file.read(data.data(), static_cast<std::streamsize>(data.size()));
+  if (!file || !is_compatible_cache_data(data, properties)) {
+    std::fputs("Vulkan backend discards an incompatible pipeline cache\n",
+               stderr);
+    return {};
+  }
+  return data;
+}
+
+} // anonymous namespace
+
+namespace beyond::graphics::vulkan {
+
+PipelineCache::PipelineCache(VkPhysicalDevice physical_device, VkDevice device,
+                             std::string path)
+    : device_{device}, path_{std::move(path)}
+{
+  vkGetPhysicalDeviceProperties(physical_device, &properties_);
+
+  const auto initial_data = read_cache_file(path_, properties_);
+  const VkPipelineCacheCreateInfo create_info{
+      .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .initialDataSize = initial_data.size(),
+      .pInitialData = initial_data.empty() ? nullptr : initial_data.data(),
+  };
+
+  if (vkCreatePipelineCache(device_, &create_info, nullptr, &cache_) !=
+      VK_SUCCESS) {
+    beyond::panic("Vulkan backend failed to create pipeline cache");
+  }
+}
+
+PipelineCache::~PipelineCache() noexcept
+{
+  destroy();
+}
+
+auto PipelineCache::save() const -> bool
+{
+  if (!device_) {
+    return false;
+  }
+
+  std::size_t size = 0;
+  if (vkGetPipelineCacheData(device_, cache_, &size, nullptr) != VK_SUCCESS) {
+    return false;
+  }
+  std::vector<char> data(size);
+  if (vkGetPipelineCacheData(device_, cache_, &size, data.data()) !=
+      VK_SUCCESS) {
+    return false;
+  }
+
+  const auto header = make_file_header(properties_, size);
+
+  // Writes to a temporary file first, so that an interrupted save never leaves
+  // a truncated cache behind
+  const auto temp_path = path_ + ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(data.data(), static_cast<std::streamsize>(size));
+    if (!file) {
+      return false;
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::rename(temp_path, path_, error);
+  return !error;
+}
+
+auto PipelineCache::destroy() noexcept -> void
+{
+  if (!device_) {
+    return;
+  }
+
+  // Saving allocates and writes files, which may throw, while destruction must
+  // not
+  bool saved = false;
+  try {
+    saved = save();
+  } catch (...) {
+  }
+  if (!saved) {
+    std::fputs("Vulkan backend failed to save the pipeline cache\n", stderr);
+  }
+  vkDestroyPipelineCache(device_, cache_, nullptr);
+  device_ = nullptr;
+}
+
+} // namespace beyond::graphics::vulkan
@@ -0,0 +1,70 @@
+#pragma once
+
+#ifndef BEYOND_GRAPHICS_VULKAN_PIPELINE_CACHE_HPP
+#define BEYOND_GRAPHICS_VULKAN_PIPELINE_CACHE_HPP
+
+#include <volk.h>
+
+#include <string>
+#include <utility>
+
+namespace beyond::graphics::vulkan {
+
+/**
+ * @brief A `VkPipelineCache` that persists on the disk between runs
+ *
+ * The cache file starts with a header that records the vendor, device,
+ * driver version and pipeline cache UUID of the physical device. A file
+ * written by another device or driver is discarded instead of handed to the
+ * driver, and the cache starts empty. The cache is written back to the file
+ * when destroyed, where failures only get reported.
+ */
+class PipelineCache {
+public:
+  PipelineCache() = default;
+  PipelineCache(VkPhysicalDevice physical_device, VkDevice device,
+                std::string path);
+  ~PipelineCache() noexcept;
+
+  PipelineCache(const PipelineCache&) = delete;
+  auto operator=(const PipelineCache&) & -> PipelineCache& = delete;
+
+  PipelineCache(PipelineCache&& other) noexcept
+      : device_{std::exchange(other.device_, nullptr)},
+        properties_{other.properties_}, cache_{std::exchange(other.cache_,
+                                                             nullptr)},
+        path_{std::move(other.path_)}
+  {
+  }
+
+  auto operator=(PipelineCache&& other) & noexcept -> PipelineCache&
+  {
+    destroy();
+    device_ = std::exchange(other.device_, nullptr);
+    properties_ = other.properties_;
+    cache_ = std::exchange(other.cache_, nullptr);
+    path_ = std::move(other.path_);
+    return *this;
+  }
+
+  [[nodiscard]] auto vkcache() const noexcept -> VkPipelineCache
+  {
+    return cache_;
+  }
+
+  /// @brief Writes the content of the cache to the file
+  /// @return `false` if the file cannot be written
+  auto save() const -> bool;
+
+private:
+  VkDevice device_ = nullptr;
+  VkPhysicalDeviceProperties properties_{};
+  VkPipelineCache cache_ = nullptr;
+  std::string path_;
+
+  auto destroy() noexcept -> void;
+};
+
+} // namespace beyond::graphics::vulkan
+
+#endif // BEYOND_GRAPHICS_VULKAN_PIPELINE_CACHE_HPP
@@ -0,0 +1,40 @@
+#pragma once
+
+#ifndef BEYOND_GRAPHICS_VULKAN_QUEUE_HPP
+#define BEYOND_GRAPHICS_VULKAN_QUEUE_HPP
+
+#include <volk.h>
+
+#include "vulkan_command_ring.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace beyond::graphics::vulkan {
+
+/// @brief The kinds of work that the context submits to separate queues
+enum struct QueueType : std::uint32_t {
+  graphics,
+  compute,
+  transfer,
+};
+
+inline constexpr std::uint32_t queue_type_count = 3;
+
+/// @brief The timeline values of every queue, indexed by queue slots
+using Timepoint = std::array<std::uint64_t, queue_type_count>;
+
+/// @brief A device queue together with the command ring that records for it
+struct Queue {
+  VkQueue queue = nullptr;
+  std::uint32_t family_index = 0;
+  CommandRing command_ring;
+
+  // The timeline values of other queues, indexed by their slots, that the
+  // submissions of this queue already wait for
+  std::array<std::uint64_t, queue_type_count> waited_values{};
+};
+
+} // namespace beyond::graphics::vulkan
+
+#endif // BEYOND_GRAPHICS_VULKAN_QUEUE_HPP
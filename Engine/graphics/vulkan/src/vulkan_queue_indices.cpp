@@ -6,42 +6,78 @@ namespace beyond::graphics::vulkan {
 auto find_queue_families(VkPhysicalDevice device, VkSurfaceKHR surface) noexcept
     -> std::optional<QueueFamilyIndices>
 {
-  std::optional<std::uint32_t> graphics_family;
-  std::optional<std::uint32_t> present_family;
-  std::optional<std::uint32_t> compute_family;
-
   const auto queue_families = get_vector_with<VkQueueFamilyProperties>(
       [device](uint32_t* count, VkQueueFamilyProperties* data) {
         vkGetPhysicalDeviceQueueFamilyProperties(device, count, data);
       });
-
   const auto families_counts = to_u32(queue_families.size());
-  for (std::uint32_t i = 0; i < families_counts; ++i) {
-    const auto& queue_family = queue_families[i];
 
-    if (queue_family.queueCount > 0 &&
-        ((queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0u)) {
-      graphics_family = i;
+  // Finds the first family that has all the `required` capabilities and none
+  // of the `excluded` ones
+  const auto find_family =
+      [&](VkQueueFlags required,
+          VkQueueFlags excluded) -> std::optional<std::uint32_t> {
+    for (std::uint32_t i = 0; i < families_counts; ++i) {
+      const auto& queue_family = queue_families[i];
+      if (queue_family.queueCount > 0 &&
+          (queue_family.queueFlags & required) == required &&
+          (queue_family.queueFlags & excluded) == 0u) {
+        return i;
+      }
     }
+    return std::nullopt;
+  };
 
-    if (queue_family.queueCount > 0 &&
-        ((queue_family.queueFlags & VK_QUEUE_COMPUTE_BIT) != 0u)) {
-      compute_family = i;
-    }
+  const auto graphics_family = find_family(VK_QUEUE_GRAPHICS_BIT, 0);
+
+  // A compute family without graphics support runs asynchronously to the
+  // graphics work
+  auto compute_family =
+      find_family(VK_QUEUE_COMPUTE_BIT, VK_QUEUE_GRAPHICS_BIT);
+  if (!compute_family) {
+    compute_family = find_family(VK_QUEUE_COMPUTE_BIT, 0);
+  }
+  if (!compute_family) {
+    return {};
+  }
 
+  // A transfer-only family is usually backed by a DMA engine. Otherwise
+  // transfers share the compute family, which always supports transfers
+  const auto transfer_family =
+      find_family(VK_QUEUE_TRANSFER_BIT,
+                  VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)
+          .value_or(*compute_family);
+
+  // Headless contexts can live without graphics and presentation
+  if (surface == nullptr) {
+    return QueueFamilyIndices{graphics_family, std::nullopt, *compute_family,
+                              transfer_family};
+  }
+
+  const auto supports_present = [&](std::uint32_t i) {
     VkBool32 present_support = false;
     vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &present_support);
-    if (queue_family.queueCount > 0 && present_support) {
-      present_family = i;
-    }
+    return queue_families[i].queueCount > 0 && present_support;
+  };
 
-    if (graphics_family && present_family && compute_family) {
-      return QueueFamilyIndices{*graphics_family, *present_family,
-                                *compute_family};
+  // Prefers presenting from the graphics family
+  std::optional<std::uint32_t> present_family;
+  if (graphics_family && supports_present(*graphics_family)) {
+    present_family = graphics_family;
+  } else {
+    for (std::uint32_t i = 0; i < families_counts; ++i) {
+      if (supports_present(i)) {
+        present_family = i;
+        break;
+      }
     }
   }
 
-  return {};
+  if (!graphics_family || !present_family) {
+    return {};
+  }
+  return QueueFamilyIndices{graphics_family, present_family, *compute_family,
+                            transfer_family};
 }
 
 } // namespace beyond::graphics::vulkan
@@ -11,17 +11,37 @@
 
 namespace beyond::graphics::vulkan {
 
+/// Only the compute and transfer families are required by headless contexts,
+/// while contexts with a surface always have all of the families. The compute
+/// and transfer families are the same one when the device has no dedicated
+/// family for them.
 struct QueueFamilyIndices {
-  std::uint32_t graphics_family;
-  std::uint32_t present_family;
-  std::uint32_t compute_family;
+  std::optional<std::uint32_t> graphics_family;
+  std::optional<std::uint32_t> present_family;
+  std::uint32_t compute_family = 0;
+  std::uint32_t transfer_family = 0;
 
   [[nodiscard]] auto to_set() const noexcept -> std::set<std::uint32_t>
   {
-    return std::set{graphics_family, present_family, compute_family};
+    std::set<std::uint32_t> result{compute_family, transfer_family};
+    if (graphics_family) {
+      result.insert(*graphics_family);
+    }
+    if (present_family) {
+      result.insert(*present_family);
+    }
+    return result;
   }
 };
 
+/**
+ * @brief Finds the queue families of a physical device
+ *
+ * Compute prefers a family without graphics support and transfer prefers a
+ * family with neither graphics nor compute support, so that they can run
+ * concurrently with the graphics queue. If `surface` is `nullptr`, the device
+ * only needs a compute queue family.
+ */
 auto find_queue_families(VkPhysicalDevice device, VkSurfaceKHR surface) noexcept
     -> std::optional<QueueFamilyIndices>;
 
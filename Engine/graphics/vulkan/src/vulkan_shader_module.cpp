@@ -1,46 +1,27 @@
 #include "vulkan_shader_module.hpp"
 
-#include <cstddef>
-#include <fstream>
+#include <algorithm>
+#include <functional>
+#include <string_view>
 
-#include <fmt/format.h>
-
-#include <beyond/utils/bit_cast.hpp>
+#include <beyond/utils/assert.hpp>
 #include <beyond/utils/panic.hpp>
 
-namespace {
-
-[[nodiscard]] auto read_file(const std::string_view filename)
-    -> std::vector<char>
-{
-
-  std::ifstream file(filename.data(), std::ios::ate | std::ios::binary);
-
-  if (!file.is_open()) {
-    // TODO(lesley): error handling
-    beyond::panic(fmt::format("failed to open file: {}\n", filename));
-  }
-
-  size_t file_size = static_cast<size_t>(file.tellg());
-  std::vector<char> buffer;
-  buffer.resize(file_size);
-
-  file.seekg(0);
-  file.read(buffer.data(), static_cast<std::streamsize>(file_size));
-
-  return buffer;
-}
-
-} // anonymous namespace
-
 namespace beyond::graphics::vulkan {
 
-[[nodiscard]] auto create_shader_module(const std::string_view& filename,
-                                        VkDevice device) -> VkShaderModule
+[[nodiscard]] auto as_spirv(gsl::span<const std::byte> bytes)
+    -> gsl::span<const std::uint32_t>
 {
-  const auto buffer = read_file(filename);
-  return create_shader_module(buffer.size(),
-                              bit_cast<const uint32_t*>(buffer.data()), device);
+  const auto size = static_cast<std::size_t>(bytes.size());
+  if (size % sizeof(std::uint32_t) != 0 ||
+      reinterpret_cast<std::uintptr_t>(bytes.data()) %
+              alignof(std::uint32_t) !=
+          0) {
+    beyond::panic("Vulkan backend got SPIR-V that is not a sequence of "
+                  "aligned words");
+  }
+  return {reinterpret_cast<const std::uint32_t*>(bytes.data()),
+          static_cast<std::ptrdiff_t>(size / sizeof(std::uint32_t))};
 }
 
 [[nodiscard]] auto create_shader_module(std::size_t size, const uint32_t* data,
@@ -65,4 +46,60 @@ namespace beyond::graphics::vulkan {
   return module;
 }
 
+ShaderModuleCache::~ShaderModuleCache() noexcept
+{
+  destroy();
+}
+
+auto ShaderModuleCache::get(gsl::span<const std::uint32_t> code)
+    -> const ShaderModule&
+{
+  const auto size = static_cast<std::size_t>(code.size_bytes());
+  const auto hash = std::hash<std::string_view>{}(
+      std::string_view{reinterpret_cast<const char*>(code.data()), size});
+
+  const auto [first, last] = modules_.equal_range(hash);
+  for (auto itr = first; itr != last; ++itr) {
+    const auto& cached = itr->second.code;
+    if (std::equal(cached.begin(), cached.end(), code.begin(), code.end())) {
+      ++itr->second.reference_count;
+      return itr->second.module;
+    }
+  }
+
+  // Reflects first, which rejects malformed code before the driver sees it
+  auto reflection = reflect_compute_shader(code);
+  const auto module = create_shader_module(size, code.data(), device_);
+  return modules_
+      .emplace(hash, Entry{.code = {code.begin(), code.end()},
+                           .module = ShaderModule{.module = module,
+                                                  .reflection =
+                                                      std::move(reflection),
+                                                  .code_hash = hash},
+                           .reference_count = 1})
+      ->second.module;
+}
+
+auto ShaderModuleCache::release(const ShaderModule& module) noexcept -> void
+{
+  const auto [first, last] = modules_.equal_range(module.code_hash);
+  const auto itr = std::find_if(first, last, [&module](const auto& entry) {
+    return &entry.second.module == &module;
+  });
+  BEYOND_ASSERT(itr != last);
+
+  if (--itr->second.reference_count == 0) {
+    vkDestroyShaderModule(device_, itr->second.module.module, nullptr);
+    modules_.erase(itr);
+  }
+}
+
+auto ShaderModuleCache::destroy() noexcept -> void
+{
+  for (const auto& [hash, entry] : modules_) {
+    vkDestroyShaderModule(device_, entry.module.module, nullptr);
+  }
+  modules_.clear();
+}
+
 } // namespace beyond::graphics::vulkan
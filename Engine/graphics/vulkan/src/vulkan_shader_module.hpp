@@ -5,17 +5,88 @@
 
 #include <volk.h>
 
-#include <string_view>
+#include <gsl/span>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "vulkan_shader_reflection.hpp"
+
 namespace beyond::graphics::vulkan {
 
-[[nodiscard]] auto create_shader_module(const std::string_view& filename,
-                                        VkDevice device) -> VkShaderModule;
+/// @brief Views the bytes of a SPIR-V binary as words, panics if they are not
+/// a whole number of aligned words
+[[nodiscard]] auto as_spirv(gsl::span<const std::byte> bytes)
+    -> gsl::span<const std::uint32_t>;
 
 [[nodiscard]] auto create_shader_module(std::size_t size, const uint32_t*,
                                         VkDevice device) -> VkShaderModule;
 
+/// @brief A shader module together with the reflection of its code
+struct ShaderModule {
+  VkShaderModule module = nullptr;
+  ShaderReflection reflection;
+  std::size_t code_hash = 0; // Finds the module in its cache
+};
+
+/**
+ * @brief Deduplicates shader modules by the contents of their SPIR-V
+ *
+ * Pipelines built from the same code share one module, so the driver parses
+ * and the backend reflects every shader only once. Every `get` takes a
+ * reference to the module, and the module is destroyed once all of them are
+ * released.
+ */
+class ShaderModuleCache {
+public:
+  ShaderModuleCache() = default;
+  explicit ShaderModuleCache(VkDevice device) : device_{device} {}
+  ~ShaderModuleCache() noexcept;
+
+  ShaderModuleCache(const ShaderModuleCache&) = delete;
+  auto operator=(const ShaderModuleCache&) & -> ShaderModuleCache& = delete;
+
+  ShaderModuleCache(ShaderModuleCache&& other) noexcept
+      : device_{std::exchange(other.device_, nullptr)},
+        modules_{std::move(other.modules_)}
+  {
+  }
+
+  auto operator=(ShaderModuleCache&& other) & noexcept -> ShaderModuleCache&
+  {
+    destroy();
+    device_ = std::exchange(other.device_, nullptr);
+    modules_ = std::move(other.modules_);
+    return *this;
+  }
+
+  /// @brief Gets the module of `code` and takes a reference to it, which
+  /// keeps the module valid until it is released
+  [[nodiscard]] auto get(gsl::span<const std::uint32_t> code)
+      -> const ShaderModule&;
+
+  /// @brief Releases a reference to `module` taken by `get`, and destroys the
+  /// module if it was the last one
+  auto release(const ShaderModule& module) noexcept -> void;
+
+private:
+  // Keeps a copy of the code to tell apart codes with colliding hashes
+  struct Entry {
+    std::vector<std::uint32_t> code;
+    ShaderModule module;
+    std::size_t reference_count = 0;
+  };
+
+  VkDevice device_ = nullptr;
+  // Keyed by the hash of the code
+  std::unordered_multimap<std::size_t, Entry> modules_;
+
+  auto destroy() noexcept -> void;
+};
+
 } // namespace beyond::graphics::vulkan
 
 #endif // BEYOND_GRAPHICS_VULKAN_SHADER_MODULE_HPP
@@ -0,0 +1,571 @@
+#include "vulkan_shader_reflection.hpp"
+
+#include <beyond/utils/panic.hpp>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+namespace beyond::graphics::vulkan {
+
+namespace {
+
+constexpr std::uint32_t spirv_magic = 0x07230203;
+constexpr std::size_t header_word_count = 5;
+// The universal limit of ids in the SPIR-V specification
+constexpr std::uint32_t max_id_bound = 0x3FFFFF;
+// Deeper type nesting than this is treated as malformed
+constexpr int max_type_depth = 64;
+
+// The subset of the SPIR-V grammar used by the reflection
+namespace op {
+constexpr std::uint32_t entry_point = 15;
+constexpr std::uint32_t execution_mode = 16;
+constexpr std::uint32_t type_bool = 20;
+constexpr std::uint32_t type_int = 21;
+constexpr std::uint32_t type_float = 22;
+constexpr std::uint32_t type_vector = 23;
+constexpr std::uint32_t type_matrix = 24;
+constexpr std::uint32_t type_image = 25;
+constexpr std::uint32_t type_sampler = 26;
+constexpr std::uint32_t type_sampled_image = 27;
+constexpr std::uint32_t type_array = 28;
+constexpr std::uint32_t type_runtime_array = 29;
+constexpr std::uint32_t type_struct = 30;
+constexpr std::uint32_t type_pointer = 32;
+constexpr std::uint32_t constant = 43;
+constexpr std::uint32_t constant_composite = 44;
+constexpr std::uint32_t spec_constant = 50;
+constexpr std::uint32_t spec_constant_composite = 51;
+constexpr std::uint32_t variable = 59;
+constexpr std::uint32_t decorate = 71;
+constexpr std::uint32_t member_decorate = 72;
+constexpr std::uint32_t execution_mode_id = 331;
+} // namespace op
+
+constexpr std::uint32_t execution_model_gl_compute = 5;
+constexpr std::uint32_t execution_mode_local_size = 17;
+constexpr std::uint32_t execution_mode_local_size_id = 38;
+
+namespace decoration {
+constexpr std::uint32_t spec_id = 1;
+constexpr std::uint32_t buffer_block = 3;
+constexpr std::uint32_t array_stride = 6;
+constexpr std::uint32_t matrix_stride = 7;
+constexpr std::uint32_t built_in = 11;
+constexpr std::uint32_t non_writable = 24;
+constexpr std::uint32_t binding = 33;
+constexpr std::uint32_t descriptor_set = 34;
+constexpr std::uint32_t offset = 35;
+} // namespace decoration
+
+constexpr std::uint32_t built_in_workgroup_size = 25;
+
+namespace storage_class {
+constexpr std::uint32_t uniform_constant = 0;
+constexpr std::uint32_t uniform = 2;
+constexpr std::uint32_t push_constant = 9;
+constexpr std::uint32_t storage_buffer = 12;
+} // namespace storage_class
+
+constexpr std::uint32_t dim_buffer = 5;
+constexpr std::uint32_t dim_subpass_data = 6;
+
+struct Decorations {
+  std::uint32_t set = 0;
+  std::uint32_t binding = 0;
+  std::uint32_t spec_id = no_spec_id;
+  std::uint32_t array_stride = 0;
+  std::uint32_t built_in = static_cast<std::uint32_t>(-1);
+  bool has_binding = false;
+  bool buffer_block = false;
+  bool non_writable = false;
+};
+
+struct MemberDecorations {
+  std::uint32_t offset = 0;
+  std::uint32_t matrix_stride = 0;
+  bool non_writable = false;
+};
+
+struct ExecutionMode {
+  std::uint32_t entry_point = 0;
+  std::uint32_t mode = 0;
+  std::array<std::uint32_t, 3> operands{};
+};
+
+// Abandons the reflection of invalid code, which the public functions report
+// in their own ways
+struct ReflectionError {
+  std::string_view message;
+};
+
+[[noreturn]] auto malformed() -> void
+{
+  throw ReflectionError{"Vulkan backend failed to reflect malformed SPIR-V"};
+}
+
+// Struct members are listed in one instruction, which limits their count
+constexpr std::uint32_t max_member_count = 0xFFFF;
+
+class Reflector {
+public:
+  explicit Reflector(gsl::span<const std::uint32_t> code) : code_{code} {}
+
+  [[nodiscard]] auto reflect() -> ShaderReflection;
+
+private:
+  gsl::span<const std::uint32_t> code_;
+  // The offset of the instruction that defines each id, or `0` if undefined
+  std::vector<std::size_t> definitions_;
+  std::vector<Decorations> decorations_;
+  std::vector<std::vector<MemberDecorations>> member_decorations_;
+  std::vector<std::uint32_t> variables_;
+  std::vector<ExecutionMode> execution_modes_;
+  std::uint32_t entry_point_ = 0;
+  bool has_entry_point_ = false;
+
+  [[nodiscard]] auto word(std::size_t offset) const -> std::uint32_t
+  {
+    if (offset >= static_cast<std::size_t>(code_.size())) {
+      malformed();
+    }
+    return code_[static_cast<std::ptrdiff_t>(offset)];
+  }
+
+  [[nodiscard]] auto checked_id(std::uint32_t id) const -> std::uint32_t
+  {
+    if (id >= definitions_.size()) {
+      malformed();
+    }
+    return id;
+  }
+
+  // Gets the offset of the instruction that defines `id`
+  [[nodiscard]] auto definition(std::uint32_t id) const -> std::size_t
+  {
+    const auto offset = definitions_[checked_id(id)];
+    if (offset == 0) {
+      malformed();
+    }
+    return offset;
+  }
+
+  [[nodiscard]] auto opcode_of(std::uint32_t id) const -> std::uint32_t
+  {
+    return word(definition(id)) & 0xFFFFu;
+  }
+
+  [[nodiscard]] auto member_decorations(std::uint32_t struct_id,
+                                        std::uint32_t member)
+      -> MemberDecorations&
+  {
+    auto& members = member_decorations_[checked_id(struct_id)];
+    if (member >= max_member_count) {
+      malformed();
+    }
+    if (member >= members.size()) {
+      members.resize(member + 1);
+    }
+    return members[member];
+  }
+
+  auto parse_instructions() -> void;
+  auto parse_entry_point(std::size_t offset, std::size_t word_count) -> void;
+  auto reflect_local_size(ShaderReflection& reflection) const -> void;
+  auto reflect_variable(std::uint32_t variable, ShaderReflection& reflection)
+      -> void;
+
+  [[nodiscard]] auto constant_value(std::uint32_t id) const -> std::uint32_t;
+  [[nodiscard]] auto size_of(std::uint32_t type, std::uint32_t matrix_stride,
+                             int depth) -> std::uint32_t;
+  [[nodiscard]] auto descriptor_type(std::uint32_t type,
+                                     std::uint32_t storage) const
+      -> VkDescriptorType;
+  [[nodiscard]] auto is_read_only(std::uint32_t variable, std::uint32_t type)
+      -> bool;
+};
+
+auto Reflector::reflect() -> ShaderReflection
+{
+  if (code_.size() < static_cast<std::ptrdiff_t>(header_word_count) ||
+      word(0) != spirv_magic || word(3) > max_id_bound) {
+    malformed();
+  }
+
+  const auto bound = word(3);
+  definitions_.assign(bound, 0);
+  decorations_.assign(bound, Decorations{});
+  member_decorations_.assign(bound, {});
+  parse_instructions();
+
+  if (!has_entry_point_) {
+    throw ReflectionError{"Vulkan backend requires a compute shader with a main "
+                          "entry point"};
+  }
+
+  ShaderReflection reflection;
+  reflect_local_size(reflection);
+  for (const auto variable : variables_) {
+    reflect_variable(variable, reflection);
+  }
+  std::sort(reflection.bindings.begin(), reflection.bindings.end(),
+            [](const ShaderBinding& lhs, const ShaderBinding& rhs) {
+              return lhs.set != rhs.set ? lhs.set < rhs.set
+                                        : lhs.binding < rhs.binding;
+            });
+  return reflection;
+}
+
+auto Reflector::parse_instructions() -> void
+{
+  const auto size = static_cast<std::size_t>(code_.size());
+  for (auto offset = header_word_count; offset < size;) {
+    const auto header = word(offset);
+    const std::size_t word_count = header >> 16u;
+    const auto opcode = header & 0xFFFFu;
+    if (word_count == 0 || offset + word_count > size) {
+      malformed();
+    }
+
+    const auto operand = [&](std::size_t index) {
+      if (index >= word_count) {
+        malformed();
+      }
+      return word(offset + index);
+    };
+
+    if (opcode >= op::type_bool && opcode <= op::type_pointer) {
+      definitions_[checked_id(operand(1))] = offset;
+    } else if (opcode >= op::constant &&
+               opcode <= op::spec_constant_composite) {
+      definitions_[checked_id(operand(2))] = offset;
+    }
+
+    switch (opcode) {
+    case op::entry_point:
+      parse_entry_point(offset, word_count);
+      break;
+    case op::execution_mode:
+    case op::execution_mode_id: {
+      ExecutionMode mode{
+          .entry_point = operand(1), .mode = operand(2), .operands = {}};
+      if (mode.mode == execution_mode_local_size ||
+          mode.mode == execution_mode_local_size_id) {
+        mode.operands = {operand(3), operand(4), operand(5)};
+      }
+      execution_modes_.push_back(mode);
+    } break;
+    case op::variable:
+      definitions_[checked_id(operand(2))] = offset;
+      variables_.push_back(operand(2));
+      break;
+    case op::decorate: {
+      auto& decorations = decorations_[checked_id(operand(1))];
+      switch (operand(2)) {
+      case decoration::spec_id:
+        decorations.spec_id = operand(3);
+        break;
+      case decoration::buffer_block:
+        decorations.buffer_block = true;
+        break;
+      case decoration::array_stride:
+        decorations.array_stride = operand(3);
+        break;
+      case decoration::built_in:
+        decorations.built_in = operand(3);
+        break;
+      case decoration::non_writable:
+        decorations.non_writable = true;
+        break;
+      case decoration::binding:
+        decorations.binding = operand(3);
+        decorations.has_binding = true;
+        break;
+      case decoration::descriptor_set:
+        decorations.set = operand(3);
+        break;
+      default:
+        break;
+      }
+    } break;
+    case op::member_decorate: {
+      auto& decorations = member_decorations(operand(1), operand(2));
+      switch (operand(3)) {
+      case decoration::offset:
+        decorations.offset = operand(4);
+        break;
+      case decoration::matrix_stride:
+        decorations.matrix_stride = operand(4);
+        break;
+      case decoration::non_writable:
+        decorations.non_writable = true;
+        break;
+      default:
+        break;
+      }
+    } break;
+    default:
+      break;
+    }
+
+    offset += word_count;
+  }
+}
+
+auto Reflector::parse_entry_point(std::size_t offset, std::size_t word_count)
+    -> void
+{
+  if (word_count < 4 || word(offset + 1) != execution_model_gl_compute) {
+    return;
+  }
+
+  // The name is a nul-terminated string packed in little endian words
+  std::string name;
+  for (std::size_t i = 3; i < word_count; ++i) {
+    const auto packed = word(offset + i);
+    for (std::uint32_t shift = 0; shift < 32; shift += 8) {
+      const auto c = static_cast<char>((packed >> shift) & 0xFFu);
+      if (c == '\0') {
+        if (name == "main") {
+          entry_point_ = word(offset + 2);
+          has_entry_point_ = true;
+        }
+        return;
+      }
+      name.push_back(c);
+    }
+  }
+  malformed();
+}
+
+auto Reflector::reflect_local_size(ShaderReflection& reflection) const -> void
+{
+  const auto set_dimension = [&](std::size_t dimension, std::uint32_t id) {
+    reflection.local_size[dimension] = constant_value(id);
+    reflection.local_size_spec_ids[dimension] =
+        opcode_of(id) == op::spec_constant ? decorations_[id].spec_id
+                                           : no_spec_id;
+  };
+
+  for (const auto& mode : execution_modes_) {
+    if (mode.entry_point != entry_point_) {
+      continue;
+    }
+    for (std::size_t i = 0; i < 3; ++i) {
+      if (mode.mode == execution_mode_local_size) {
+        reflection.local_size[i] = mode.operands[i];
+      } else if (mode.mode == execution_mode_local_size_id) {
+        set_dimension(i, mode.operands[i]);
+      }
+    }
+  }
+
+  // A constant decorated with the `WorkgroupSize` built-in overrides the
+  // execution modes, which is how `local_size_x_id` compiles
+  for (std::uint32_t id = 0; id < decorations_.size(); ++id) {
+    if (decorations_[id].built_in != built_in_workgroup_size ||
+        definitions_[id] == 0) {
+      continue;
+    }
+    const auto offset = definition(id);
+    const auto opcode = word(offset) & 0xFFFFu;
+    if (opcode != op::constant_composite &&
+        opcode != op::spec_constant_composite) {
+      malformed();
+    }
+    for (std::size_t i = 0; i < 3; ++i) {
+      set_dimension(i, word(offset + 3 + i));
+    }
+  }
+}
+
+auto Reflector::reflect_variable(std::uint32_t variable,
+                                 ShaderReflection& reflection) -> void
+{
+  const auto offset = definition(variable);
+  const auto storage = word(offset + 3);
+  const auto pointer = definition(word(offset + 1));
+  if ((word(pointer) & 0xFFFFu) != op::type_pointer) {
+    malformed();
+  }
+  auto type = word(pointer + 3);
+
+  if (storage == storage_class::push_constant) {
+    reflection.push_constant_size = std::max(reflection.push_constant_size,
+                                             size_of(type, 0, 0));
+    return;
+  }
+  if (storage != storage_class::uniform_constant &&
+      storage != storage_class::uniform &&
+      storage != storage_class::storage_buffer) {
+    return;
+  }
+
+  const auto& decorations = decorations_[variable];
+  if (!decorations.has_binding) {
+    return;
+  }
+
+  std::uint32_t count = 1;
+  if (opcode_of(type) == op::type_array) {
+    count = constant_value(word(definition(type) + 3));
+    type = word(definition(type) + 2);
+  } else if (opcode_of(type) == op::type_runtime_array) {
+    count = 0;
+    type = word(definition(type) + 2);
+  }
+
+  reflection.bindings.push_back(ShaderBinding{
+      .set = decorations.set,
+      .binding = decorations.binding,
+      .type = descriptor_type(type, storage),
+      .count = count,
+      .read_only = is_read_only(variable, type),
+  });
+}
+
+auto Reflector::constant_value(std::uint32_t id) const -> std::uint32_t
+{
+  const auto offset = definition(id);
+  const auto opcode = word(offset) & 0xFFFFu;
+  if (opcode != op::constant && opcode != op::spec_constant) {
+    malformed();
+  }
+  return word(offset + 3);
+}
+
+auto Reflector::size_of(std::uint32_t type, std::uint32_t matrix_stride,
+                        int depth) -> std::uint32_t
+{
+  if (depth > max_type_depth) {
+    malformed();
+  }
+
+  const auto offset = definition(type);
+  switch (word(offset) & 0xFFFFu) {
+  case op::type_bool:
+    return 4;
+  case op::type_int:
+  case op::type_float:
+    return word(offset + 2) / 8;
+  case op::type_vector:
+    return word(offset + 3) * size_of(word(offset + 2), 0, depth + 1);
+  case op::type_matrix: {
+    const auto column_size =
+        matrix_stride != 0 ? matrix_stride
+                           : size_of(word(offset + 2), 0, depth + 1);
+    return word(offset + 3) * column_size;
+  }
+  case op::type_array: {
+    const auto stride = decorations_[type].array_stride;
+    const auto element_size =
+        stride != 0 ? stride
+                    : size_of(word(offset + 2), matrix_stride, depth + 1);
+    return constant_value(word(offset + 3)) * element_size;
+  }
+  case op::type_runtime_array:
+    return 0;
+  case op::type_pointer:
+    return 8; // Physical storage buffer addresses
+  case op::type_struct: {
+    const auto member_count = (word(offset) >> 16u) - 2;
+    std::uint32_t size = 0;
+    for (std::uint32_t member = 0; member < member_count; ++member) {
+      const auto decorations = member_decorations(type, member);
+      const auto member_size = size_of(word(offset + 2 + member),
+                                       decorations.matrix_stride, depth + 1);
+      size = std::max(size, decorations.offset + member_size);
+    }
+    return size;
+  }
+  default:
+    malformed();
+  }
+}
+
+auto Reflector::descriptor_type(std::uint32_t type,
+                                std::uint32_t storage) const
+    -> VkDescriptorType
+{
+  if (storage == storage_class::storage_buffer) {
+    return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  }
+  if (storage == storage_class::uniform) {
+    // Storage buffers of SPIR-V before 1.3 are uniform buffer blocks
+    return decorations_[checked_id(type)].buffer_block
+               ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER
+               : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+  }
+
+  const auto offset = definition(type);
+  switch (word(offset) & 0xFFFFu) {
+  case op::type_sampler:
+    return VK_DESCRIPTOR_TYPE_SAMPLER;
+  case op::type_sampled_image:
+    return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  case op::type_image: {
+    const auto dim = word(offset + 3);
+    const bool storage_image = word(offset + 7) == 2;
+    if (dim == dim_buffer) {
+      return storage_image ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER
+                           : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+    }
+    if (dim == dim_subpass_data) {
+      return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+    }
+    return storage_image ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE
+                         : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+  }
+  default:
+    throw ReflectionError{
+        "Vulkan backend cannot reflect an unknown descriptor type"};
+  }
+}
+
+auto Reflector::is_read_only(std::uint32_t variable, std::uint32_t type)
+    -> bool
+{
+  if (decorations_[variable].non_writable) {
+    return true;
+  }
+  if (opcode_of(type) != op::type_struct) {
+    return false;
+  }
+
+  // GLSL `readonly` blocks decorate every member instead of the variable
+  const auto member_count = (word(definition(type)) >> 16u) - 2;
+  if (member_count == 0) {
+    return false;
+  }
+  for (std::uint32_t member = 0; member < member_count; ++member) {
+    if (!member_decorations(type, member).non_writable) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+auto reflect_compute_shader(gsl::span<const std::uint32_t> code)
+    -> ShaderReflection
+{
+  try {
+    return Reflector{code}.reflect();
+  } catch (const ReflectionError& error) {
+    beyond::panic(error.message);
+  }
+}
+
+auto try_reflect_compute_shader(gsl::span<const std::uint32_t> code)
+    -> std::optional<ShaderReflection>
+{
+  try {
+    return Reflector{code}.reflect();
+  } catch (const ReflectionError&) {
+    return std::nullopt;
+  }
+}
+
+} // namespace beyond::graphics::vulkan
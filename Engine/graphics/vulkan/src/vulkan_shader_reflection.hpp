@@ -0,0 +1,61 @@
+#pragma once
+
+#ifndef BEYOND_GRAPHICS_VULKAN_SHADER_REFLECTION_HPP
+#define BEYOND_GRAPHICS_VULKAN_SHADER_REFLECTION_HPP
+
+#include <volk.h>
+
+#include <gsl/span>
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace beyond::graphics::vulkan {
+
+/// @brief A resource that a shader declares
+struct ShaderBinding {
+  std::uint32_t set = 0;
+  std::uint32_t binding = 0;
+  VkDescriptorType type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  std::uint32_t count = 1; // `0` for runtime sized arrays
+  // The shader never writes the resource, i.e. it is `readonly` in GLSL
+  bool read_only = false;
+};
+
+/// @brief Marks a dimension of the local size that is not specializable
+inline constexpr std::uint32_t no_spec_id = static_cast<std::uint32_t>(-1);
+
+/// @brief The interface of a compute shader
+struct ShaderReflection {
+  /// Sorted by set and then by binding
+  std::vector<ShaderBinding> bindings;
+  /// The end of the last member of the push constant block, in bytes
+  std::uint32_t push_constant_size = 0;
+  /// The local size, where the specializable dimensions hold their defaults
+  std::array<std::uint32_t, 3> local_size = {1, 1, 1};
+  /// The specialization constant ids of the local size dimensions
+  std::array<std::uint32_t, 3> local_size_spec_ids = {no_spec_id, no_spec_id,
+                                                      no_spec_id};
+};
+
+/**
+ * @brief Extracts the interface of the `main` compute entry point from SPIR-V
+ *
+ * Only reads what pipeline creation needs, which are the descriptors, the
+ * push constant block and the local size. Panics if `code` is not valid
+ * SPIR-V or has no `main` compute entry point.
+ */
+[[nodiscard]] auto reflect_compute_shader(gsl::span<const std::uint32_t> code)
+    -> ShaderReflection;
+
+/// @brief Reflects like `reflect_compute_shader`, but returns `std::nullopt`
+/// instead of panicking on invalid code
+[[nodiscard]] auto
+try_reflect_compute_shader(gsl::span<const std::uint32_t> code)
+    -> std::optional<ShaderReflection>;
+
+} // namespace beyond::graphics::vulkan
+
+#endif // BEYOND_GRAPHICS_VULKAN_SHADER_REFLECTION_HPP
@@ -0,0 +1,98 @@
+#include "vulkan_staging_ring.hpp"
+
+#include <beyond/utils/assert.hpp>
+#include <beyond/utils/panic.hpp>
+
+namespace beyond::graphics::vulkan {
+
+namespace {
+
+[[nodiscard]] constexpr auto align_up(VkDeviceSize value,
+                                      VkDeviceSize alignment) noexcept
+    -> VkDeviceSize
+{
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+} // anonymous namespace
+
+StagingRing::StagingRing(VmaAllocator allocator, VkDeviceSize capacity)
+    : allocator_{allocator}, capacity_{capacity}
+{
+  const VkBufferCreateInfo buffer_info{
+      .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+      .pNext = nullptr,
+      .flags = 0,
+      .size = capacity,
+      .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+      .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+      .queueFamilyIndexCount = 0,
+      .pQueueFamilyIndices = nullptr,
+  };
+
+  VmaAllocationCreateInfo alloc_info{};
+  alloc_info.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+  alloc_info.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+  VmaAllocationInfo allocation_info{};
+  if (vmaCreateBuffer(allocator_, &buffer_info, &alloc_info, &buffer_,
+                      &allocation_, &allocation_info) != VK_SUCCESS) {
+    beyond::panic("Vulkan backend failed to allocate the staging buffer");
+  }
+  data_ = static_cast<std::byte*>(allocation_info.pMappedData);
+}
+
+StagingRing::~StagingRing() noexcept
+{
+  destroy();
+}
+
+auto StagingRing::allocate(VkDeviceSize size, std::uint64_t serial)
+    -> std::optional<VkDeviceSize>
+{
+  BEYOND_ASSERT(size != 0);
+
+  if (regions_.empty()) {
+    head_ = 0;
+    tail_ = 0;
+  }
+
+  auto offset = align_up(head_, alignment);
+  if (head_ >= tail_) {
+    if (offset + size <= capacity_) {
+      head_ = offset + size;
+      regions_.push_back({head_, serial});
+      return offset;
+    }
+    // Wraps around and leaves the end of the ring unused until this region
+    // retires
+    offset = 0;
+  }
+
+  // The head never catches up the tail, so that a full ring is never
+  // mistaken as an empty one
+  if (offset + size >= tail_) {
+    return std::nullopt;
+  }
+  head_ = offset + size;
+  regions_.push_back({head_, serial});
+  return offset;
+}
+
+auto StagingRing::retire(std::uint64_t completed_serial) noexcept -> void
+{
+  while (!regions_.empty() && regions_.front().serial <= completed_serial) {
+    tail_ = regions_.front().end;
+    regions_.pop_front();
+  }
+}
+
+auto StagingRing::destroy() noexcept -> void
+{
+  if (allocator_) {
+    vmaDestroyBuffer(allocator_, buffer_, allocation_);
+    allocator_ = nullptr;
+  }
+}
+
+} // namespace beyond::graphics::vulkan
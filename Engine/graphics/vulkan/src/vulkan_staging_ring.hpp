@@ -0,0 +1,133 @@
+#pragma once
+
+#ifndef BEYOND_GRAPHICS_VULKAN_STAGING_RING_HPP
+#define BEYOND_GRAPHICS_VULKAN_STAGING_RING_HPP
+
+#include <vk_mem_alloc.h>
+#include <volk.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <utility>
+
+namespace beyond::graphics::vulkan {
+
+/**
+ * @brief A persistently mapped host visible buffer that sub-allocates staging
+ * space for uploads
+ *
+ * Every allocation is tagged with the serial of the submission that reads it.
+ * Space is handed out in FIFO order and returns to the ring once `retire` is
+ * called with a completed serial, so uploads never create Vulkan objects.
+ */
+class StagingRing {
+public:
+  static constexpr VkDeviceSize default_capacity = 16 * 1024 * 1024;
+
+  StagingRing() = default;
+  explicit StagingRing(VmaAllocator allocator,
+                       VkDeviceSize capacity = default_capacity);
+  ~StagingRing() noexcept;
+
+  StagingRing(const StagingRing&) = delete;
+  auto operator=(const StagingRing&) & -> StagingRing& = delete;
+
+  StagingRing(StagingRing&& other) noexcept
+      : allocator_{std::exchange(other.allocator_, nullptr)},
+        buffer_{std::exchange(other.buffer_, nullptr)},
+        allocation_{std::exchange(other.allocation_, nullptr)},
+        data_{std::exchange(other.data_, nullptr)},
+        capacity_{std::exchange(other.capacity_, 0)},
+        head_{std::exchange(other.head_, 0)},
+        tail_{std::exchange(other.tail_, 0)}, regions_{std::move(
+                                                  other.regions_)}
+  {
+  }
+
+  auto operator=(StagingRing&& other) & noexcept -> StagingRing&
+  {
+    destroy();
+    allocator_ = std::exchange(other.allocator_, nullptr);
+    buffer_ = std::exchange(other.buffer_, nullptr);
+    allocation_ = std::exchange(other.allocation_, nullptr);
+    data_ = std::exchange(other.data_, nullptr);
+    capacity_ = std::exchange(other.capacity_, 0);
+    head_ = std::exchange(other.head_, 0);
+    tail_ = std::exchange(other.tail_, 0);
+    regions_ = std::move(other.regions_);
+    return *this;
+  }
+
+  [[nodiscard]] auto vkbuffer() const noexcept -> VkBuffer
+  {
+    return buffer_;
+  }
+
+  [[nodiscard]] auto capacity() const noexcept -> VkDeviceSize
+  {
+    return capacity_;
+  }
+
+  /// @brief Gets the mapped address of `offset`
+  [[nodiscard]] auto data(VkDeviceSize offset) const noexcept -> std::byte*
+  {
+    return data_ + offset;
+  }
+
+  /**
+   * @brief Sub-allocates `size` contiguous bytes that stay in flight until the
+   * submission of `serial` retires
+   * @return The offset of the allocation, or `std::nullopt` if the ring does
+   * not have enough free space
+   */
+  [[nodiscard]] auto allocate(VkDeviceSize size, std::uint64_t serial)
+      -> std::optional<VkDeviceSize>;
+
+  /// @brief Releases all allocations of submissions up to `completed_serial`
+  auto retire(std::uint64_t completed_serial) noexcept -> void;
+
+  /// @brief Gets the serial of the oldest allocation still in flight
+  [[nodiscard]] auto oldest_serial() const noexcept
+      -> std::optional<std::uint64_t>
+  {
+    if (regions_.empty()) {
+      return std::nullopt;
+    }
+    return regions_.front().serial;
+  }
+
+  /// @brief Flushes host writes to a range of the ring
+  auto flush(VkDeviceSize offset, VkDeviceSize size) noexcept -> void
+  {
+    vmaFlushAllocation(allocator_, allocation_, offset, size);
+  }
+
+private:
+  // Keeps the source offsets of copies friendly to memcpy and DMA engines
+  static constexpr VkDeviceSize alignment = 16;
+
+  struct Region {
+    VkDeviceSize end = 0;
+    std::uint64_t serial = 0;
+  };
+
+  VmaAllocator allocator_ = nullptr;
+  VkBuffer buffer_ = nullptr;
+  VmaAllocation allocation_ = nullptr;
+  std::byte* data_ = nullptr;
+  VkDeviceSize capacity_ = 0;
+
+  // Free space is [head_, capacity_) + [0, tail_) when head_ >= tail_, and
+  // [head_, tail_) after the head wrapped around
+  VkDeviceSize head_ = 0;
+  VkDeviceSize tail_ = 0;
+  std::deque<Region> regions_;
+
+  auto destroy() noexcept -> void;
+};
+
+} // namespace beyond::graphics::vulkan
+
+#endif // BEYOND_GRAPHICS_VULKAN_STAGING_RING_HPP
@@ -103,8 +103,8 @@ VulkanSwapchain::VulkanSwapchain(VkPhysicalDevice pd, VkDevice device,
   create_info.imageArrayLayers = 1;
   create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
-  std::array queue_family_indices = {indices.graphics_family,
-                                     indices.present_family};
+  std::array queue_family_indices = {*indices.graphics_family,
+                                     *indices.present_family};
 
   if (indices.graphics_family != indices.present_family) {
     create_info.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
@@ -4,6 +4,7 @@
 #define BEYOND_GRAPHICS_VULKAN_UTILS_HPP
 
 #include <cstdint>
+#include <functional>
 #include <vector>
 
 namespace beyond::graphics::vulkan {
@@ -27,6 +28,13 @@ template <typename T> constexpr auto to_u32(T value) noexcept -> std::uint32_t
   return static_cast<std::uint32_t>(value);
 }
 
+/// @brief Mixes the hash of `value` into `seed`
+template <typename T>
+auto hash_combine(std::size_t& seed, const T& value) noexcept -> void
+{
+  seed ^= std::hash<T>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
 } // namespace beyond::graphics::vulkan
 
 #endif // BEYOND_GRAPHICS_VULKAN_UTILS_HPP
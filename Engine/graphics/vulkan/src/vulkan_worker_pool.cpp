@@ -0,0 +1,90 @@
+#include "vulkan_worker_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+namespace beyond::graphics::vulkan {
+
+WorkerPool::WorkerPool(std::uint32_t thread_count)
+{
+  threads_.reserve(thread_count);
+  for (std::uint32_t i = 0; i < thread_count; ++i) {
+    threads_.emplace_back([this, i]() { run(i); });
+  }
+}
+
+WorkerPool::~WorkerPool() noexcept
+{
+  {
+    std::scoped_lock lock{mutex_};
+    stopping_ = true;
+  }
+  condition_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+auto WorkerPool::enqueue(Task task) -> void
+{
+  {
+    std::scoped_lock lock{mutex_};
+    tasks_.push_back(std::move(task));
+  }
+  condition_.notify_one();
+}
+
+auto WorkerPool::parallel_for(
+    std::size_t count,
+    const std::function<void(std::size_t index, std::uint32_t thread_index)>&
+        task) -> void
+{
+  if (count == 0) {
+    return;
+  }
+
+  // Every worker pulls indices until all of them are taken, which balances
+  // uneven tasks better than splitting the range up front
+  std::atomic<std::size_t> next_index = 0;
+  const auto worker_count =
+      static_cast<std::uint32_t>(std::min<std::size_t>(count, thread_count()));
+
+  std::mutex done_mutex;
+  std::condition_variable done_condition;
+  std::uint32_t running = worker_count;
+
+  for (std::uint32_t i = 0; i < worker_count; ++i) {
+    enqueue([&](std::uint32_t thread_index) {
+      for (auto index = next_index++; index < count; index = next_index++) {
+        task(index, thread_index);
+      }
+
+      std::scoped_lock lock{done_mutex};
+      if (--running == 0) {
+        done_condition.notify_one();
+      }
+    });
+  }
+
+  std::unique_lock lock{done_mutex};
+  done_condition.wait(lock, [&]() { return running == 0; });
+}
+
+auto WorkerPool::run(std::uint32_t thread_index) -> void
+{
+  while (true) {
+    Task task;
+    {
+      std::unique_lock lock{mutex_};
+      condition_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task(thread_index);
+  }
+}
+
+} // namespace beyond::graphics::vulkan
@@ -0,0 +1,66 @@
+#pragma once
+
+#ifndef BEYOND_GRAPHICS_VULKAN_WORKER_POOL_HPP
+#define BEYOND_GRAPHICS_VULKAN_WORKER_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace beyond::graphics::vulkan {
+
+/**
+ * @brief A fixed set of threads that execute tasks in FIFO order
+ *
+ * Every task receives the index of the thread that runs it, which is in
+ * `[0, thread_count())`, so that tasks can use per-thread resources without
+ * locking.
+ */
+class WorkerPool {
+public:
+  using Task = std::function<void(std::uint32_t thread_index)>;
+
+  explicit WorkerPool(std::uint32_t thread_count);
+
+  /// @brief Finishes all the enqueued tasks and joins the threads
+  ~WorkerPool() noexcept;
+
+  WorkerPool(const WorkerPool&) = delete;
+  auto operator=(const WorkerPool&) & -> WorkerPool& = delete;
+  WorkerPool(WorkerPool&&) = delete;
+  auto operator=(WorkerPool&&) & -> WorkerPool& = delete;
+
+  [[nodiscard]] auto thread_count() const noexcept -> std::uint32_t
+  {
+    return static_cast<std::uint32_t>(threads_.size());
+  }
+
+  auto enqueue(Task task) -> void;
+
+  /**
+   * @brief Calls `task(index, thread_index)` for every index in `[0, count)`
+   * and blocks until all the calls return
+   */
+  auto parallel_for(
+      std::size_t count,
+      const std::function<void(std::size_t index, std::uint32_t thread_index)>&
+          task) -> void;
+
+private:
+  std::vector<std::thread> threads_;
+  std::deque<Task> tasks_;
+  std::mutex mutex_;
+  std::condition_variable condition_;
+  bool stopping_ = false;
+
+  auto run(std::uint32_t thread_index) -> void;
+};
+
+} // namespace beyond::graphics::vulkan
+
+#endif // BEYOND_GRAPHICS_VULKAN_WORKER_POOL_HPP
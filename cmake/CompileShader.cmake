@@ -17,3 +17,24 @@ function(compile_shader)
    )
    add_custom_target(${ARGV0} DEPENDS ${COMPILE_SHADER_TARGET})
 endfunction()
+
+set(EmbedShadersScript ${CMAKE_CURRENT_LIST_DIR}/EmbedShaders.cmake)
+
+# Generates a C++ header that embeds the compiled SPIR-V files in SHADERS,
+# which are looked up by their file names without the .spv extension
+function(embed_shaders)
+   set(OneValueArgs HEADER)
+   set(MultiValueArgs SHADERS)
+   cmake_parse_arguments(EMBED_SHADERS "" "${OneValueArgs}" "${MultiValueArgs}" ${ARGN})
+
+   get_filename_component(HeaderDir ${EMBED_SHADERS_HEADER} DIRECTORY)
+   string(REPLACE ";" "|" Shaders "${EMBED_SHADERS_SHADERS}")
+   add_custom_command(
+      COMMAND ${CMAKE_COMMAND} ARGS -E make_directory ${HeaderDir}
+      COMMAND ${CMAKE_COMMAND} ARGS -DHEADER=${EMBED_SHADERS_HEADER} -DSHADERS=${Shaders} -P ${EmbedShadersScript}
+      DEPENDS ${EMBED_SHADERS_SHADERS} ${EmbedShadersScript}
+      OUTPUT ${EMBED_SHADERS_HEADER}
+      VERBATIM
+   )
+   add_custom_target(${ARGV0} DEPENDS ${EMBED_SHADERS_HEADER})
+endfunction()
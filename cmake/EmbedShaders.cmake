@@ -0,0 +1,59 @@
+# Writes SPIR-V binaries as constexpr arrays into a C++ header, together with
+# a registry of them keyed by their file names without the .spv extension
+#
+# Run in script mode with:
+#   HEADER  - the header to write
+#   SHADERS - the SPIR-V files, separated by '|'
+
+string(REPLACE "|" ";" Shaders "${SHADERS}")
+
+set(Arrays "")
+set(Entries "")
+foreach(Shader ${Shaders})
+   get_filename_component(Name ${Shader} NAME)
+   string(REGEX REPLACE "\\.spv$" "" Name ${Name})
+   string(MAKE_C_IDENTIFIER ${Name} Identifier)
+
+   file(READ ${Shader} Bytes HEX)
+   string(LENGTH "${Bytes}" Length)
+   math(EXPR Remainder "${Length} % 8")
+   if(Length EQUAL 0 OR NOT Remainder EQUAL 0)
+      message(FATAL_ERROR "${Shader} is not a SPIR-V binary")
+   endif()
+
+   # SPIR-V words are little-endian, eight of them per line
+   string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1, " Words ${Bytes})
+   set(Word "0x[0-9a-f]+, ")
+   string(REGEX REPLACE "(${Word}${Word}${Word}${Word}${Word}${Word}${Word}${Word})"
+          "\\1\n    " Words ${Words})
+   string(STRIP "${Words}" Words)
+   string(REPLACE ", \n" ",\n" Words "${Words}")
+
+   string(APPEND Arrays
+          "inline constexpr std::uint32_t ${Identifier}[] = {\n    ${Words}\n};\n\n")
+   string(APPEND Entries
+          "    EmbeddedShader{\"${Name}\", ${Identifier},\n"
+          "                   sizeof(${Identifier}) / sizeof(std::uint32_t)},\n")
+endforeach()
+
+file(WRITE ${HEADER}
+"// Generated by cmake/EmbedShaders.cmake, do not edit
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace beyond::graphics::vulkan::embedded {
+
+struct EmbeddedShader {
+  const char* name;
+  const std::uint32_t* code;
+  std::size_t size; // In words
+};
+
+${Arrays}inline constexpr EmbeddedShader shaders[] = {
+${Entries}};
+
+} // namespace beyond::graphics::vulkan::embedded
+")